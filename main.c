@@ -30,61 +30,43 @@
 #include <stdlib.h>
 #include "wau8.h"
 #include "mywheels.h"
+#include "wau8_verify.h"
+#include "wau8_check.h"
 
 #define TEST_BUFF_SZ    (16U)
 
 
-#define XWHEELCT (4U)
-uint8_t xbuff[262144];
-
-void sanity_check(void)
+// works out period and coverage of a wheel geometry and checks them
+void check_geometry(const char * name, const uint16_t * psizes, const size_t count)
 {
-    size_t ii;
-    size_t jj;
-    
-    // declare some relatively prime wheel sizes
-    // and number of bits needed to store each wheel size
-    // total bits is 18; 2^18 is 262144
-    // expected number of wheel pos combos is product of wheel sizes
-    const int xrp[XWHEELCT] = { 14 /* 2x7 */, 15 /* 3x5 */, 23, 29 };
-    const int xbits[XWHEELCT] = { 4,4,5,5 };
-    const int ncombos = xrp[0] * xrp[1] * xrp[2] * xrp[3];
-
-    // init wheel positions and flag buffer
-    int xct[XWHEELCT] = { 0,0,0,0 };
-    memset(xbuff, 0, sizeof(xbuff));
-
-    // loop through expected number of combos
-    for (jj = 0; jj < ncombos; jj++)
-    {
-        // create index based on wheel positions
-        int ix = 0;
-        for (ii = 0; ii < XWHEELCT; ii++)
-        {
-            ix <<= xbits[ii];
-            ix += xct[ii];
-        }
-        
-        // flag each occurrence of index
-        xbuff[ix] = 1;
-
-        // advance the wheels
-        for (ii = 0; ii < XWHEELCT; ii++)
-        {
-            xct[ii] = (xct[ii] + 1) % xrp[ii];
-        }
-    }
+    wau8_verify_result_t result;
+    wau8_verify(psizes, count, NULL, &result);
+
+    printf("%s: period 2^%.2f of 2^%.2f joint positions, %s coverage\n",
+        name, result.log2_period, result.log2_states,
+        result.full_coverage ? "full" : "partial");
+    printf("%s: %llu joint positions checked %s, %llu failures\n",
+        name, (unsigned long long)result.checked,
+        result.exhaustive ? "exhaustively" : "by sampling",
+        (unsigned long long)result.failures);
+}
+
 
-    // count number of times each index was flagged
-    int nflags = 0;
-    for (jj = 0; jj < sizeof(xbuff); jj++)
+// compares every fast path with the reference implementation
+void check_paths(void)
+{
+    wau8_check_result_t result;
+    wau8_check(NULL, &result);
+
+    printf("paths: %llu cases, %llu checks of %llu bytes, %llu failures\n",
+        (unsigned long long)result.cases,
+        (unsigned long long)result.checks,
+        (unsigned long long)result.bytes,
+        (unsigned long long)result.failures);
+    if (result.failures != 0U)
     {
-        if (xbuff[jj] > 0) nflags++;
+        printf("paths: first failure %s\n", result.first);
     }
-
-    // number of flagged indexes
-    // should equal number of expected combos
-    printf("%i %i\n", ncombos, nflags);
 }
 
 
@@ -95,37 +77,19 @@ void process_message(
     char * otxt,
     const size_t sz)
 {
-    size_t jj;
-    uint8_t val;
-
-    // loop through input bytes
-    for (jj = 0; jj < sz; jj++)
-    {
-        val = wau8_get_val(pcon);
-        wau8_advance(pcon);
-
-        // encrypt or decrypt input value
-        otxt[jj] = itxt[jj] ^ val;
-    }
+    wau8_xor(pcon, (const uint8_t *)itxt, (uint8_t *)otxt, sz);
 }
 
 
 void set_rand_wheels(unsigned int seed)
 {
-    srand(seed);
-    for (int nn = 0; nn < WAU8_WHEEL_SZ[0]; nn++) rand_wheels.a[nn] = rand();
-    for (int nn = 0; nn < WAU8_WHEEL_SZ[1]; nn++) rand_wheels.b[nn] = rand();
-    for (int nn = 0; nn < WAU8_WHEEL_SZ[2]; nn++) rand_wheels.c[nn] = rand();
-    for (int nn = 0; nn < WAU8_WHEEL_SZ[3]; nn++) rand_wheels.d[nn] = rand();
-    for (int nn = 0; nn < WAU8_WHEEL_SZ[4]; nn++) rand_wheels.e[nn] = rand();
-    for (int nn = 0; nn < WAU8_WHEEL_SZ[5]; nn++) rand_wheels.f[nn] = rand();
-    for (int nn = 0; nn < WAU8_WHEEL_SZ[6]; nn++) rand_wheels.g[nn] = rand();
-    for (int nn = 0; nn < WAU8_WHEEL_SZ[7]; nn++) rand_wheels.h[nn] = rand();
+    wau8_make_wheels(&rand_wheels, seed);
 }
 
 
 void wau8_test(const wau8_wheels_t * pw)
 {
+    static wau8_ext_wheels_t xwheels;
     wau8_context_t con;
 
     // key rolls over to all 0s at next advance
@@ -138,6 +102,8 @@ void wau8_test(const wau8_wheels_t * pw)
     char btxt[TEST_BUFF_SZ];
 
     wau8_set_wheels(&con, pw);
+    wau8_make_ext_wheels(&xwheels, pw);
+    wau8_set_ext_wheels(&con, &xwheels);
 
     printf("\n----\n");
     printf("ENCRYPT\n");
@@ -162,7 +128,12 @@ void wau8_test(const wau8_wheels_t * pw)
 
 int main(int argc, char* argv[])
 {
-    sanity_check();
+    // toy geometry small enough to check every joint position
+    // and the geometry the library was built with
+    const uint16_t toy_sizes[] = { 14 /* 2x7 */, 15 /* 3x5 */, 23, 29 };
+    check_geometry("toy", toy_sizes, sizeof(toy_sizes) / sizeof(toy_sizes[0]));
+    check_geometry("wau8", WAU8_WHEEL_SZ, WAU8_KEY_SZ);
+    check_paths();
     
     // "null" wheels are all 0 so ciphertext will equal plaintext and vice versa
     
@@ -27,26 +27,15 @@
 
 #include "mywheels.h"
 
+// one initializer per wheel so every field is set whatever the geometry
+#define GEN_ZERO_WHEEL(nm, ix, sz)      { 0 },
+
 const wau8_wheels_t null_wheels =
 {
-    { 0 },
-    { 0 },
-    { 0 },
-    { 0 },
-    { 0 },
-    { 0 },
-    { 0 },
-    { 0 },
+    WAU8_WHEELS(GEN_ZERO_WHEEL)
 };
 
 wau8_wheels_t rand_wheels =
 {
-    { 0 },
-    { 0 },
-    { 0 },
-    { 0 },
-    { 0 },
-    { 0 },
-    { 0 },
-    { 0 },
+    WAU8_WHEELS(GEN_ZERO_WHEEL)
 };
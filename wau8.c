@@ -25,232 +25,420 @@
 
 // Mark Whitney 2020
 
+#include <string.h>
 #include "wau8.h"
+#include "wau8_simd.h"
+#include "wau8_perf.h"
+#include "wau8_util.h"
 
 
-typedef struct
-{
-    uint8_t b[253];
-    uint8_t c[251];
-    uint8_t d[249];
-    uint8_t e[247];
-    uint8_t f[245];
-    uint8_t g[241];
-    uint8_t h[239];
-} wau8_cheats_t;
-
+#define GEN_SIZE(nm, ix, sz)    sz,
 
-
-// relatively prime wheel sizes
-// should yield cycle size of 2^63.613300375511121451554498835938
 const uint16_t WAU8_WHEEL_SZ[WAU8_KEY_SZ] =
 {
-    256U,   // 256 (2^8)
-    253U,   // 253 (11x23)
-    251U,   // 251 (prime)
-    249U,   // 249 (3x83),
-    247U,   // 247 (13x19)
-    245U,   // 245 (5x7x7)
-    241U,   // 241 (prime)
-    239U    // 239 (prime)
+    WAU8_WHEELS(GEN_SIZE)
 };
 
 
-// cheat table for incrementing wheel position and handling
-// wraparound without having to do modulo or use an if-block
-// wheel 256 has no table since it rolls over from 255 to 0 automatically
-static const wau8_cheats_t WAU8_CHEATS =
-{
-// wheel 253
+
+// set initial wheel positions (the key)
+// do modulo operations to prevent key value from exceeding wheel size
+// starting positions are remembered so wheels can be moved to any offset
+#define GEN_SET_KEY(nm, ix, sz) \
+    pcontext->pos##nm = (WAU8_POS_T)((*pkey)[ix] % (sz)); \
+    pcontext->key[ix] = pcontext->pos##nm;
+
+void wau8_set_key(wau8_context_t* pcontext, const wau8_key_t pkey)
 {
-1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 9U, 10U, 11U, 12U, 13U, 14U, 15U,
-16U, 17U, 18U, 19U, 20U, 21U, 22U, 23U, 24U, 25U, 26U, 27U, 28U, 29U, 30U,
-31U, 32U, 33U, 34U, 35U, 36U, 37U, 38U, 39U, 40U, 41U, 42U, 43U, 44U, 45U,
-46U, 47U, 48U, 49U, 50U, 51U, 52U, 53U, 54U, 55U, 56U, 57U, 58U, 59U, 60U,
-61U, 62U, 63U, 64U, 65U, 66U, 67U, 68U, 69U, 70U, 71U, 72U, 73U, 74U, 75U,
-76U, 77U, 78U, 79U, 80U, 81U, 82U, 83U, 84U, 85U, 86U, 87U, 88U, 89U, 90U,
-91U, 92U, 93U, 94U, 95U, 96U, 97U, 98U, 99U, 100U, 101U, 102U, 103U, 104U, 105U,
-106U, 107U, 108U, 109U, 110U, 111U, 112U, 113U, 114U, 115U, 116U, 117U, 118U, 119U, 120U,
-121U, 122U, 123U, 124U, 125U, 126U, 127U, 128U, 129U, 130U, 131U, 132U, 133U, 134U, 135U,
-136U, 137U, 138U, 139U, 140U, 141U, 142U, 143U, 144U, 145U, 146U, 147U, 148U, 149U, 150U,
-151U, 152U, 153U, 154U, 155U, 156U, 157U, 158U, 159U, 160U, 161U, 162U, 163U, 164U, 165U,
-166U, 167U, 168U, 169U, 170U, 171U, 172U, 173U, 174U, 175U, 176U, 177U, 178U, 179U, 180U,
-181U, 182U, 183U, 184U, 185U, 186U, 187U, 188U, 189U, 190U, 191U, 192U, 193U, 194U, 195U,
-196U, 197U, 198U, 199U, 200U, 201U, 202U, 203U, 204U, 205U, 206U, 207U, 208U, 209U, 210U,
-211U, 212U, 213U, 214U, 215U, 216U, 217U, 218U, 219U, 220U, 221U, 222U, 223U, 224U, 225U,
-226U, 227U, 228U, 229U, 230U, 231U, 232U, 233U, 234U, 235U, 236U, 237U, 238U, 239U, 240U,
-241U, 242U, 243U, 244U, 245U, 246U, 247U, 248U, 249U, 250U, 251U, 252U, 0U,
-},
-// wheel 251
+    WAU8_WHEELS(GEN_SET_KEY)
+    pcontext->offset = 0U;
+}
+
+
+void wau8_set_wheels(wau8_context_t* pcontext, const wau8_wheels_t * pwheels)
 {
-1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 9U, 10U, 11U, 12U, 13U, 14U, 15U,
-16U, 17U, 18U, 19U, 20U, 21U, 22U, 23U, 24U, 25U, 26U, 27U, 28U, 29U, 30U,
-31U, 32U, 33U, 34U, 35U, 36U, 37U, 38U, 39U, 40U, 41U, 42U, 43U, 44U, 45U,
-46U, 47U, 48U, 49U, 50U, 51U, 52U, 53U, 54U, 55U, 56U, 57U, 58U, 59U, 60U,
-61U, 62U, 63U, 64U, 65U, 66U, 67U, 68U, 69U, 70U, 71U, 72U, 73U, 74U, 75U,
-76U, 77U, 78U, 79U, 80U, 81U, 82U, 83U, 84U, 85U, 86U, 87U, 88U, 89U, 90U,
-91U, 92U, 93U, 94U, 95U, 96U, 97U, 98U, 99U, 100U, 101U, 102U, 103U, 104U, 105U,
-106U, 107U, 108U, 109U, 110U, 111U, 112U, 113U, 114U, 115U, 116U, 117U, 118U, 119U, 120U,
-121U, 122U, 123U, 124U, 125U, 126U, 127U, 128U, 129U, 130U, 131U, 132U, 133U, 134U, 135U,
-136U, 137U, 138U, 139U, 140U, 141U, 142U, 143U, 144U, 145U, 146U, 147U, 148U, 149U, 150U,
-151U, 152U, 153U, 154U, 155U, 156U, 157U, 158U, 159U, 160U, 161U, 162U, 163U, 164U, 165U,
-166U, 167U, 168U, 169U, 170U, 171U, 172U, 173U, 174U, 175U, 176U, 177U, 178U, 179U, 180U,
-181U, 182U, 183U, 184U, 185U, 186U, 187U, 188U, 189U, 190U, 191U, 192U, 193U, 194U, 195U,
-196U, 197U, 198U, 199U, 200U, 201U, 202U, 203U, 204U, 205U, 206U, 207U, 208U, 209U, 210U,
-211U, 212U, 213U, 214U, 215U, 216U, 217U, 218U, 219U, 220U, 221U, 222U, 223U, 224U, 225U,
-226U, 227U, 228U, 229U, 230U, 231U, 232U, 233U, 234U, 235U, 236U, 237U, 238U, 239U, 240U,
-241U, 242U, 243U, 244U, 245U, 246U, 247U, 248U, 249U, 250U, 0U,
-},
-// wheel 249
+    pcontext->pwheels = pwheels;
+    pcontext->pxwheels = NULL;
+    pcontext->pfwheels = NULL;
+}
+
+
+// fills a set of wheels with pseudo-random values made from a seed
+// each 8 bytes comes from mixing the seed with a counter (the splitmix64
+// finalizer) so there's no shared state, any number of threads can make
+// wheel sets at once, and the loop can be vectorized
+// bytes are taken little-endian so a seed gives the same wheels everywhere
+// (this is for making test and demo wheels, not for key material)
+void wau8_make_wheels(wau8_wheels_t * pwheels, const uint64_t seed)
 {
-1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 9U, 10U, 11U, 12U, 13U, 14U, 15U,
-16U, 17U, 18U, 19U, 20U, 21U, 22U, 23U, 24U, 25U, 26U, 27U, 28U, 29U, 30U,
-31U, 32U, 33U, 34U, 35U, 36U, 37U, 38U, 39U, 40U, 41U, 42U, 43U, 44U, 45U,
-46U, 47U, 48U, 49U, 50U, 51U, 52U, 53U, 54U, 55U, 56U, 57U, 58U, 59U, 60U,
-61U, 62U, 63U, 64U, 65U, 66U, 67U, 68U, 69U, 70U, 71U, 72U, 73U, 74U, 75U,
-76U, 77U, 78U, 79U, 80U, 81U, 82U, 83U, 84U, 85U, 86U, 87U, 88U, 89U, 90U,
-91U, 92U, 93U, 94U, 95U, 96U, 97U, 98U, 99U, 100U, 101U, 102U, 103U, 104U, 105U,
-106U, 107U, 108U, 109U, 110U, 111U, 112U, 113U, 114U, 115U, 116U, 117U, 118U, 119U, 120U,
-121U, 122U, 123U, 124U, 125U, 126U, 127U, 128U, 129U, 130U, 131U, 132U, 133U, 134U, 135U,
-136U, 137U, 138U, 139U, 140U, 141U, 142U, 143U, 144U, 145U, 146U, 147U, 148U, 149U, 150U,
-151U, 152U, 153U, 154U, 155U, 156U, 157U, 158U, 159U, 160U, 161U, 162U, 163U, 164U, 165U,
-166U, 167U, 168U, 169U, 170U, 171U, 172U, 173U, 174U, 175U, 176U, 177U, 178U, 179U, 180U,
-181U, 182U, 183U, 184U, 185U, 186U, 187U, 188U, 189U, 190U, 191U, 192U, 193U, 194U, 195U,
-196U, 197U, 198U, 199U, 200U, 201U, 202U, 203U, 204U, 205U, 206U, 207U, 208U, 209U, 210U,
-211U, 212U, 213U, 214U, 215U, 216U, 217U, 218U, 219U, 220U, 221U, 222U, 223U, 224U, 225U,
-226U, 227U, 228U, 229U, 230U, 231U, 232U, 233U, 234U, 235U, 236U, 237U, 238U, 239U, 240U,
-241U, 242U, 243U, 244U, 245U, 246U, 247U, 248U, 0U,
-},
-// wheel 247
+    // wheels are laid out one after another so this fills them in order
+    uint8_t * p = (uint8_t *)pwheels;
+    const size_t nwords = sizeof(*pwheels) / 8U;
+    size_t ii;
+    size_t jj;
+
+    for (ii = 0; ii < nwords; ii++)
+    {
+        uint64_t val = wau8_mix64(seed + ((uint64_t)(ii + 1U) * WAU8_MIX_GAMMA));
+        for (jj = 0; jj < 8U; jj++)
+        {
+            p[(ii * 8U) + jj] = (uint8_t)(val >> (8U * jj));
+        }
+    }
+
+    if ((nwords * 8U) < sizeof(*pwheels))
+    {
+        uint64_t val = wau8_mix64(seed + ((uint64_t)(nwords + 1U) * WAU8_MIX_GAMMA));
+        for (jj = nwords * 8U; jj < sizeof(*pwheels); jj++)
+        {
+            p[jj] = (uint8_t)val;
+            val >>= 8U;
+        }
+    }
+}
+
+
+// copies each wheel and repeats its first values at the end
+// (wheels smaller than the padding get repeated as many times as needed)
+#define GEN_MAKE_EXT(nm, ix, sz) \
+    for (jj = 0; jj < ((sz) + WAU8_EXT_PAD); jj++) \
+    { \
+        pxwheels->nm[jj] = pwheels->nm[jj % (sz)]; \
+    }
+
+void wau8_make_ext_wheels(
+    wau8_ext_wheels_t * pxwheels,
+    const wau8_wheels_t * pwheels)
 {
-1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 9U, 10U, 11U, 12U, 13U, 14U, 15U,
-16U, 17U, 18U, 19U, 20U, 21U, 22U, 23U, 24U, 25U, 26U, 27U, 28U, 29U, 30U,
-31U, 32U, 33U, 34U, 35U, 36U, 37U, 38U, 39U, 40U, 41U, 42U, 43U, 44U, 45U,
-46U, 47U, 48U, 49U, 50U, 51U, 52U, 53U, 54U, 55U, 56U, 57U, 58U, 59U, 60U,
-61U, 62U, 63U, 64U, 65U, 66U, 67U, 68U, 69U, 70U, 71U, 72U, 73U, 74U, 75U,
-76U, 77U, 78U, 79U, 80U, 81U, 82U, 83U, 84U, 85U, 86U, 87U, 88U, 89U, 90U,
-91U, 92U, 93U, 94U, 95U, 96U, 97U, 98U, 99U, 100U, 101U, 102U, 103U, 104U, 105U,
-106U, 107U, 108U, 109U, 110U, 111U, 112U, 113U, 114U, 115U, 116U, 117U, 118U, 119U, 120U,
-121U, 122U, 123U, 124U, 125U, 126U, 127U, 128U, 129U, 130U, 131U, 132U, 133U, 134U, 135U,
-136U, 137U, 138U, 139U, 140U, 141U, 142U, 143U, 144U, 145U, 146U, 147U, 148U, 149U, 150U,
-151U, 152U, 153U, 154U, 155U, 156U, 157U, 158U, 159U, 160U, 161U, 162U, 163U, 164U, 165U,
-166U, 167U, 168U, 169U, 170U, 171U, 172U, 173U, 174U, 175U, 176U, 177U, 178U, 179U, 180U,
-181U, 182U, 183U, 184U, 185U, 186U, 187U, 188U, 189U, 190U, 191U, 192U, 193U, 194U, 195U,
-196U, 197U, 198U, 199U, 200U, 201U, 202U, 203U, 204U, 205U, 206U, 207U, 208U, 209U, 210U,
-211U, 212U, 213U, 214U, 215U, 216U, 217U, 218U, 219U, 220U, 221U, 222U, 223U, 224U, 225U,
-226U, 227U, 228U, 229U, 230U, 231U, 232U, 233U, 234U, 235U, 236U, 237U, 238U, 239U, 240U,
-241U, 242U, 243U, 244U, 245U, 246U, 0U,
-},
-// wheel 245
+    unsigned int jj;
+    WAU8_WHEELS(GEN_MAKE_EXT)
+}
+
+
+// lets the bulk functions use the vector kernels
+// extended wheels must be made from the wheels given to wau8_set_wheels
+void wau8_set_ext_wheels(
+    wau8_context_t * pcontext,
+    const wau8_ext_wheels_t * pxwheels)
 {
-1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 9U, 10U, 11U, 12U, 13U, 14U, 15U,
-16U, 17U, 18U, 19U, 20U, 21U, 22U, 23U, 24U, 25U, 26U, 27U, 28U, 29U, 30U,
-31U, 32U, 33U, 34U, 35U, 36U, 37U, 38U, 39U, 40U, 41U, 42U, 43U, 44U, 45U,
-46U, 47U, 48U, 49U, 50U, 51U, 52U, 53U, 54U, 55U, 56U, 57U, 58U, 59U, 60U,
-61U, 62U, 63U, 64U, 65U, 66U, 67U, 68U, 69U, 70U, 71U, 72U, 73U, 74U, 75U,
-76U, 77U, 78U, 79U, 80U, 81U, 82U, 83U, 84U, 85U, 86U, 87U, 88U, 89U, 90U,
-91U, 92U, 93U, 94U, 95U, 96U, 97U, 98U, 99U, 100U, 101U, 102U, 103U, 104U, 105U,
-106U, 107U, 108U, 109U, 110U, 111U, 112U, 113U, 114U, 115U, 116U, 117U, 118U, 119U, 120U,
-121U, 122U, 123U, 124U, 125U, 126U, 127U, 128U, 129U, 130U, 131U, 132U, 133U, 134U, 135U,
-136U, 137U, 138U, 139U, 140U, 141U, 142U, 143U, 144U, 145U, 146U, 147U, 148U, 149U, 150U,
-151U, 152U, 153U, 154U, 155U, 156U, 157U, 158U, 159U, 160U, 161U, 162U, 163U, 164U, 165U,
-166U, 167U, 168U, 169U, 170U, 171U, 172U, 173U, 174U, 175U, 176U, 177U, 178U, 179U, 180U,
-181U, 182U, 183U, 184U, 185U, 186U, 187U, 188U, 189U, 190U, 191U, 192U, 193U, 194U, 195U,
-196U, 197U, 198U, 199U, 200U, 201U, 202U, 203U, 204U, 205U, 206U, 207U, 208U, 209U, 210U,
-211U, 212U, 213U, 214U, 215U, 216U, 217U, 218U, 219U, 220U, 221U, 222U, 223U, 224U, 225U,
-226U, 227U, 228U, 229U, 230U, 231U, 232U, 233U, 234U, 235U, 236U, 237U, 238U, 239U, 240U,
-241U, 242U, 243U, 244U, 0U,
-},
-// wheel 241
+    pcontext->pxwheels = pxwheels;
+}
+
+
+// builds the table for a pair of wheels
+// entry j is the XOR of the two wheel values at joint step j
+static void make_pair(
+    uint8_t * ptab,
+    const uint8_t * pw0,
+    const unsigned int sz0,
+    const uint8_t * pw1,
+    const unsigned int sz1)
 {
-1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 9U, 10U, 11U, 12U, 13U, 14U, 15U,
-16U, 17U, 18U, 19U, 20U, 21U, 22U, 23U, 24U, 25U, 26U, 27U, 28U, 29U, 30U,
-31U, 32U, 33U, 34U, 35U, 36U, 37U, 38U, 39U, 40U, 41U, 42U, 43U, 44U, 45U,
-46U, 47U, 48U, 49U, 50U, 51U, 52U, 53U, 54U, 55U, 56U, 57U, 58U, 59U, 60U,
-61U, 62U, 63U, 64U, 65U, 66U, 67U, 68U, 69U, 70U, 71U, 72U, 73U, 74U, 75U,
-76U, 77U, 78U, 79U, 80U, 81U, 82U, 83U, 84U, 85U, 86U, 87U, 88U, 89U, 90U,
-91U, 92U, 93U, 94U, 95U, 96U, 97U, 98U, 99U, 100U, 101U, 102U, 103U, 104U, 105U,
-106U, 107U, 108U, 109U, 110U, 111U, 112U, 113U, 114U, 115U, 116U, 117U, 118U, 119U, 120U,
-121U, 122U, 123U, 124U, 125U, 126U, 127U, 128U, 129U, 130U, 131U, 132U, 133U, 134U, 135U,
-136U, 137U, 138U, 139U, 140U, 141U, 142U, 143U, 144U, 145U, 146U, 147U, 148U, 149U, 150U,
-151U, 152U, 153U, 154U, 155U, 156U, 157U, 158U, 159U, 160U, 161U, 162U, 163U, 164U, 165U,
-166U, 167U, 168U, 169U, 170U, 171U, 172U, 173U, 174U, 175U, 176U, 177U, 178U, 179U, 180U,
-181U, 182U, 183U, 184U, 185U, 186U, 187U, 188U, 189U, 190U, 191U, 192U, 193U, 194U, 195U,
-196U, 197U, 198U, 199U, 200U, 201U, 202U, 203U, 204U, 205U, 206U, 207U, 208U, 209U, 210U,
-211U, 212U, 213U, 214U, 215U, 216U, 217U, 218U, 219U, 220U, 221U, 222U, 223U, 224U, 225U,
-226U, 227U, 228U, 229U, 230U, 231U, 232U, 233U, 234U, 235U, 236U, 237U, 238U, 239U, 240U,
-0U,
-},
-// wheel 239
+    unsigned int pos0 = 0U;
+    unsigned int pos1 = 0U;
+    unsigned int jj;
+
+    for (jj = 0; jj < (sz0 * sz1); jj++)
+    {
+        ptab[jj] = pw0[pos0] ^ pw1[pos1];
+        pos0 = WAU8_WRAP_INC(pos0, sz0);
+        pos1 = WAU8_WRAP_INC(pos1, sz1);
+    }
+}
+
+
+// returns inverse of x modulo m (x and m relatively prime)
+static uint32_t inv_mod(const uint32_t x, const uint32_t m)
 {
-1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 9U, 10U, 11U, 12U, 13U, 14U, 15U,
-16U, 17U, 18U, 19U, 20U, 21U, 22U, 23U, 24U, 25U, 26U, 27U, 28U, 29U, 30U,
-31U, 32U, 33U, 34U, 35U, 36U, 37U, 38U, 39U, 40U, 41U, 42U, 43U, 44U, 45U,
-46U, 47U, 48U, 49U, 50U, 51U, 52U, 53U, 54U, 55U, 56U, 57U, 58U, 59U, 60U,
-61U, 62U, 63U, 64U, 65U, 66U, 67U, 68U, 69U, 70U, 71U, 72U, 73U, 74U, 75U,
-76U, 77U, 78U, 79U, 80U, 81U, 82U, 83U, 84U, 85U, 86U, 87U, 88U, 89U, 90U,
-91U, 92U, 93U, 94U, 95U, 96U, 97U, 98U, 99U, 100U, 101U, 102U, 103U, 104U, 105U,
-106U, 107U, 108U, 109U, 110U, 111U, 112U, 113U, 114U, 115U, 116U, 117U, 118U, 119U, 120U,
-121U, 122U, 123U, 124U, 125U, 126U, 127U, 128U, 129U, 130U, 131U, 132U, 133U, 134U, 135U,
-136U, 137U, 138U, 139U, 140U, 141U, 142U, 143U, 144U, 145U, 146U, 147U, 148U, 149U, 150U,
-151U, 152U, 153U, 154U, 155U, 156U, 157U, 158U, 159U, 160U, 161U, 162U, 163U, 164U, 165U,
-166U, 167U, 168U, 169U, 170U, 171U, 172U, 173U, 174U, 175U, 176U, 177U, 178U, 179U, 180U,
-181U, 182U, 183U, 184U, 185U, 186U, 187U, 188U, 189U, 190U, 191U, 192U, 193U, 194U, 195U,
-196U, 197U, 198U, 199U, 200U, 201U, 202U, 203U, 204U, 205U, 206U, 207U, 208U, 209U, 210U,
-211U, 212U, 213U, 214U, 215U, 216U, 217U, 218U, 219U, 220U, 221U, 222U, 223U, 224U, 225U,
-226U, 227U, 228U, 229U, 230U, 231U, 232U, 233U, 234U, 235U, 236U, 237U, 238U, 0U,
-},
-};
+    int64_t t0 = 0;
+    int64_t t1 = 1;
+    int64_t r0 = m;
+    int64_t r1 = x % m;
 
+    while (r1 != 0)
+    {
+        int64_t q = r0 / r1;
+        int64_t tmp;
+        tmp = t0 - (q * t1); t0 = t1; t1 = tmp;
+        tmp = r0 - (q * r1); r0 = r1; r1 = tmp;
+    }
 
+    return (uint32_t)((t0 < 0) ? (t0 + m) : t0);
+}
 
-// set initial wheel positions (the key)
-// do modulo operations to prevent key value from exceeding wheel size
-void wau8_set_key(wau8_context_t* pcontext, const wau8_key_t pkey)
+
+// builds the fused tables for a set of wheels
+// this is a one-time cost worth paying for wheel sets that encrypt a lot of data
+#define GEN_MAKE_PAIR(pr, nm0, sz0, nm1, sz1) \
+    make_pair(pfwheels->pr, pwheels->nm0, sz0, pwheels->nm1, sz1); \
+    pfwheels->inv##pr = inv_mod(sz0, sz1);
+
+void wau8_make_fused_wheels(
+    wau8_fused_wheels_t * pfwheels,
+    const wau8_wheels_t * pwheels)
 {
-    pcontext->posa = (*pkey)[0];
-    pcontext->posb = (*pkey)[1] % WAU8_WHEEL_SZ[1];
-    pcontext->posc = (*pkey)[2] % WAU8_WHEEL_SZ[2];
-    pcontext->posd = (*pkey)[3] % WAU8_WHEEL_SZ[3];
-    pcontext->pose = (*pkey)[4] % WAU8_WHEEL_SZ[4];
-    pcontext->posf = (*pkey)[5] % WAU8_WHEEL_SZ[5];
-    pcontext->posg = (*pkey)[6] % WAU8_WHEEL_SZ[6];
-    pcontext->posh = (*pkey)[7] % WAU8_WHEEL_SZ[7];
+    WAU8_WHEEL_PAIRS(GEN_MAKE_PAIR)
 }
 
 
-void wau8_set_wheels(wau8_context_t* pcontext, const wau8_wheels_t * pwheels)
+// lets the bulk functions use fused tables for bytes not done by a vector kernel
+// fused wheels must be made from the wheels given to wau8_set_wheels
+void wau8_set_fused_wheels(
+    wau8_context_t * pcontext,
+    const wau8_fused_wheels_t * pfwheels)
 {
-    pcontext->pwheels = pwheels;
+    pcontext->pfwheels = pfwheels;
 }
 
 
 // advance the wheels
+#define GEN_ADVANCE(nm, ix, sz) \
+    pcontext->pos##nm = (WAU8_POS_T)WAU8_WRAP_INC(pcontext->pos##nm, sz);
+
 void wau8_advance(wau8_context_t * pcontext)
 {
     // increment positions and perform wraparound
-    pcontext->posa++;
-    pcontext->posb = WAU8_CHEATS.b[pcontext->posb];
-    pcontext->posc = WAU8_CHEATS.c[pcontext->posc];
-    pcontext->posd = WAU8_CHEATS.d[pcontext->posd];
-    pcontext->pose = WAU8_CHEATS.e[pcontext->pose];
-    pcontext->posf = WAU8_CHEATS.f[pcontext->posf];
-    pcontext->posg = WAU8_CHEATS.g[pcontext->posg];
-    pcontext->posg = WAU8_CHEATS.h[pcontext->posh];
+    WAU8_WHEELS(GEN_ADVANCE)
+    pcontext->offset++;
+}
+
+
+// moves the wheels to where they would be after offset advances from the key
+// each wheel position is just the key position plus offset wrapped to the wheel size
+#define GEN_SEEK(nm, ix, sz) \
+    pcontext->pos##nm = (WAU8_POS_T)((pcontext->key[ix] + (offset % (sz))) % (sz));
+
+void wau8_seek(wau8_context_t * pcontext, const uint64_t offset)
+{
+    WAU8_WHEELS(GEN_SEEK)
+    pcontext->offset = offset;
+}
+
+
+// returns number of advances since the key was set
+uint64_t wau8_get_offset(const wau8_context_t * pcontext)
+{
+    return pcontext->offset;
 }
 
 
 // returns the current encrypting/decrypting byte
+#define GEN_GET_VAL(nm, ix, sz) \
+    result ^= pcontext->pwheels->nm[pcontext->pos##nm];
+
 uint8_t wau8_get_val(const wau8_context_t * pcontext)
 {
     uint8_t result = 0U;
-    result ^= pcontext->pwheels->a[pcontext->posa];
-    result ^= pcontext->pwheels->b[pcontext->posb];
-    result ^= pcontext->pwheels->c[pcontext->posc];
-    result ^= pcontext->pwheels->d[pcontext->posd];
-    result ^= pcontext->pwheels->e[pcontext->pose];
-    result ^= pcontext->pwheels->f[pcontext->posf];
-    result ^= pcontext->pwheels->g[pcontext->posg];
-    result ^= pcontext->pwheels->h[pcontext->posh];
+    WAU8_WHEELS(GEN_GET_VAL)
     return result;
 }
+
+
+
+// fills buffer with the next sz encrypting/decrypting bytes
+// wheels are left positioned just past the last byte
+void wau8_keystream(wau8_context_t * pcontext, uint8_t * pbuff, const size_t sz)
+{
+    memset(pbuff, 0, sz);
+    wau8_xor(pcontext, pbuff, pbuff, sz);
+}
+
+
+// encrypts/decrypts one byte at a time
+// wheel positions are kept in locals for the whole call
+// instead of going through the context for every byte
+#define GEN_LOAD_POS(nm, ix, sz)    unsigned int pos##nm = pcontext->pos##nm;
+#define GEN_LOOKUP(nm, ix, sz)      val ^= pw->nm[pos##nm];
+#define GEN_INC_POS(nm, ix, sz)     pos##nm = WAU8_WRAP_INC(pos##nm, sz);
+#define GEN_SAVE_POS(nm, ix, sz)    pcontext->pos##nm = (WAU8_POS_T)pos##nm;
+
+static void xor_scalar(
+    wau8_context_t * pcontext,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz)
+{
+    const wau8_wheels_t * pw = pcontext->pwheels;
+    WAU8_WHEELS(GEN_LOAD_POS)
+    size_t jj;
+
+    for (jj = 0; jj < sz; jj++)
+    {
+        uint8_t val = 0U;
+        WAU8_WHEELS(GEN_LOOKUP)
+        pdst[jj] = psrc[jj] ^ val;
+        WAU8_WHEELS(GEN_INC_POS)
+    }
+
+    WAU8_WHEELS(GEN_SAVE_POS)
+}
+
+
+// finds joint step of a pair of wheels from their positions
+// (chinese remainder theorem, wheel sizes are relatively prime)
+// inv0 is the inverse of sz0 modulo sz1
+static uint32_t pair_step(
+    const uint32_t pos0,
+    const uint32_t sz0,
+    const uint32_t pos1,
+    const uint32_t sz1,
+    const uint32_t inv0)
+{
+    uint32_t diff = ((pos1 + sz1) - (pos0 % sz1)) % sz1;
+    return pos0 + (sz0 * (uint32_t)(((uint64_t)diff * inv0) % sz1));
+}
+
+
+// encrypts/decrypts one byte at a time with one lookup per fused pair
+// the joint step of each pair is computed once on the way in
+// and split back into wheel positions on the way out
+#define GEN_PAIR_LOAD(pr, nm0, sz0, nm1, sz1) \
+    uint32_t j##pr = pair_step(pcontext->pos##nm0, sz0, pcontext->pos##nm1, sz1, pf->inv##pr);
+#define GEN_PAIR_LOOKUP(pr, nm0, sz0, nm1, sz1) \
+    val ^= pf->pr[j##pr];
+#define GEN_PAIR_INC(pr, nm0, sz0, nm1, sz1) \
+    j##pr = WAU8_WRAP_INC(j##pr, (sz0) * (sz1));
+#define GEN_PAIR_SAVE(pr, nm0, sz0, nm1, sz1) \
+    pcontext->pos##nm0 = (WAU8_POS_T)(j##pr % (sz0)); \
+    pcontext->pos##nm1 = (WAU8_POS_T)(j##pr % (sz1));
+
+static void xor_fused(
+    wau8_context_t * pcontext,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz)
+{
+    const wau8_fused_wheels_t * pf = pcontext->pfwheels;
+    const wau8_wheels_t * pw = pcontext->pwheels;   // for wheels not in a pair
+    WAU8_WHEEL_PAIRS(GEN_PAIR_LOAD)
+    WAU8_WHEEL_SINGLES(GEN_LOAD_POS)
+    size_t jj;
+
+    for (jj = 0; jj < sz; jj++)
+    {
+        uint8_t val = 0U;
+        WAU8_WHEEL_PAIRS(GEN_PAIR_LOOKUP)
+        WAU8_WHEEL_SINGLES(GEN_LOOKUP)
+        pdst[jj] = psrc[jj] ^ val;
+        WAU8_WHEEL_PAIRS(GEN_PAIR_INC)
+        WAU8_WHEEL_SINGLES(GEN_INC_POS)
+    }
+
+    WAU8_WHEEL_PAIRS(GEN_PAIR_SAVE)
+    WAU8_WHEEL_SINGLES(GEN_SAVE_POS)
+    (void)pw;
+}
+
+
+// encrypts/decrypts sz bytes from source buffer into destination buffer
+// source and destination may be the same buffer for in-place operation
+// whole vector blocks go through the vector kernels
+// if extended wheels have been set, the rest is done a byte at a time
+// using fused wheels if they have been set
+#define GEN_POS_TO_ARRAY(nm, ix, sz)    pos[ix] = pcontext->pos##nm;
+#define GEN_POS_FROM_ARRAY(nm, ix, sz)  pcontext->pos##nm = (WAU8_POS_T)pos[ix];
+
+void wau8_xor(
+    wau8_context_t * pcontext,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz)
+{
+    size_t done = 0U;
+    WAU8_PERF_BEGIN()
+
+    if (pcontext->pxwheels != NULL)
+    {
+        unsigned int pos[WAU8_KEY_SZ];
+        WAU8_WHEELS(GEN_POS_TO_ARRAY)
+        done = wau8_xor_vec(pos, pcontext->pxwheels, psrc, pdst, sz);
+        WAU8_WHEELS(GEN_POS_FROM_ARRAY)
+    }
+
+    if (pcontext->pfwheels != NULL)
+    {
+        xor_fused(pcontext, psrc + done, pdst + done, sz - done);
+    }
+    else
+    {
+        xor_scalar(pcontext, psrc + done, pdst + done, sz - done);
+    }
+    pcontext->offset += sz;
+    WAU8_PERF_END(done, sz)
+}
+
+
+// encrypts/decrypts a buffer in place
+void wau8_xor_inplace(wau8_context_t * pcontext, uint8_t * pbuff, const size_t sz)
+{
+    wau8_xor(pcontext, pbuff, pbuff, sz);
+}
+
+
+// encrypts/decrypts a list of source segments into a list of destination
+// segments as if each list were one contiguous buffer
+// the keystream runs on across segment boundaries and the two lists
+// don't need to be split in the same places
+// stops when either list runs out, returns number of bytes done
+size_t wau8_xorv(
+    wau8_context_t * pcontext,
+    const wau8_iovec_t * psrc_iov,
+    const size_t src_count,
+    const wau8_iovec_t * pdst_iov,
+    const size_t dst_count)
+{
+    size_t isrc = 0U;
+    size_t idst = 0U;
+    size_t src_used = 0U;
+    size_t dst_used = 0U;
+    size_t total = 0U;
+
+    while ((isrc < src_count) && (idst < dst_count))
+    {
+        size_t src_left = psrc_iov[isrc].sz - src_used;
+        size_t dst_left = pdst_iov[idst].sz - dst_used;
+        size_t n = (src_left < dst_left) ? src_left : dst_left;
+
+        wau8_xor(
+            pcontext,
+            psrc_iov[isrc].pbase + src_used,
+            pdst_iov[idst].pbase + dst_used,
+            n);
+        total += n;
+
+        src_used += n;
+        if (src_used == psrc_iov[isrc].sz)
+        {
+            isrc++;
+            src_used = 0U;
+        }
+
+        dst_used += n;
+        if (dst_used == pdst_iov[idst].sz)
+        {
+            idst++;
+            dst_used = 0U;
+        }
+    }
+
+    return total;
+}
+
+
+// encrypts/decrypts a list of segments in place, returns number of bytes done
+size_t wau8_xorv_inplace(
+    wau8_context_t * pcontext,
+    const wau8_iovec_t * piov,
+    const size_t count)
+{
+    size_t total = 0U;
+    size_t ii;
+
+    for (ii = 0; ii < count; ii++)
+    {
+        wau8_xor(pcontext, piov[ii].pbase, piov[ii].pbase, piov[ii].sz);
+        total += piov[ii].sz;
+    }
+
+    return total;
+}
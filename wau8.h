@@ -32,46 +32,125 @@
 extern "C" {
 #endif
 
+#include <stddef.h>
 #include <stdint.h>
+#include "wau8_geom.h"
 
-#define WAU8_KEY_SZ             (8U)
+// helpers for expanding the wheel lists in wau8_geom.h
+#define WAU8_GEN_COUNT(nm, ix, sz)              + 1U
+#define WAU8_GEN_WHEEL(nm, ix, sz)              uint8_t nm[sz];
+#define WAU8_GEN_EXT_WHEEL(nm, ix, sz)          uint8_t nm[(sz) + WAU8_EXT_PAD];
+#define WAU8_GEN_PAIR(pr, nm0, sz0, nm1, sz1)   uint8_t pr[(sz0) * (sz1)];
+#define WAU8_GEN_PAIR_INV(pr, nm0, sz0, nm1, sz1) uint32_t inv##pr;
+#define WAU8_GEN_POS(nm, ix, sz)                WAU8_POS_T pos##nm;
+
+// one key value per wheel
+#define WAU8_KEY_SZ             (0U WAU8_WHEELS(WAU8_GEN_COUNT))
+
+// number of values each extended wheel repeats from its start
+#define WAU8_EXT_PAD            (64U)
 
 
 typedef const uint8_t (*wau8_key_t)[WAU8_KEY_SZ];
 
+// kernels the bulk functions can use with extended wheels
+typedef enum
+{
+    WAU8_BACKEND_AUTO = 0,
+    WAU8_BACKEND_SCALAR,
+    WAU8_BACKEND_SSE2,
+    WAU8_BACKEND_AVX2,
+    WAU8_BACKEND_AVX512,
+} wau8_backend_t;
+
 typedef struct
 {
-    uint8_t a[256];
-    uint8_t b[253];
-    uint8_t c[251];
-    uint8_t d[249];
-    uint8_t e[247];
-    uint8_t f[245];
-    uint8_t g[241];
-    uint8_t h[239];
+    WAU8_WHEELS(WAU8_GEN_WHEEL)
 } wau8_wheels_t;
 
+// wheels extended with a copy of their first WAU8_EXT_PAD values
+// so that a run of consecutive values starting at any position
+// can be read without having to handle wraparound
+typedef struct
+{
+    WAU8_WHEELS(WAU8_GEN_EXT_WHEEL)
+} wau8_ext_wheels_t;
+
+// wheels that always move together fused into one table per pair
+// each table holds the XOR of the pair over their joint period
+// so a keystream byte takes one lookup per pair instead of two
+// (4 instead of 8 for the default wheels, about 240 KB of tables)
+// fusing more than two wheels per table would need ~16 MB per table
+// the inverses are used to find a pair's joint step from its positions
+typedef struct
+{
+    WAU8_WHEEL_PAIRS(WAU8_GEN_PAIR)
+    WAU8_WHEEL_PAIRS(WAU8_GEN_PAIR_INV)
+} wau8_fused_wheels_t;
+
+// one segment of a scatter/gather list
+// (same fields as POSIX struct iovec)
+typedef struct
+{
+    uint8_t * pbase;
+    size_t sz;
+} wau8_iovec_t;
+
 typedef struct
 {
-    uint8_t posa;
-    uint8_t posb;
-    uint8_t posc;
-    uint8_t posd;
-    uint8_t pose;
-    uint8_t posf;
-    uint8_t posg;
-    uint8_t posh;
+    WAU8_WHEELS(WAU8_GEN_POS)
+    WAU8_POS_T key[WAU8_KEY_SZ];
+    uint64_t offset;
     const wau8_wheels_t * pwheels;
+    const wau8_ext_wheels_t * pxwheels;
+    const wau8_fused_wheels_t * pfwheels;
 } wau8_context_t;
 
-
 extern const uint16_t WAU8_WHEEL_SZ[WAU8_KEY_SZ];
 
 
 void wau8_set_key(wau8_context_t * pcontext, const wau8_key_t pkey);
 void wau8_set_wheels(wau8_context_t* pcontext, const wau8_wheels_t * pwheels);
+void wau8_make_wheels(wau8_wheels_t * pwheels, const uint64_t seed);
+void wau8_make_ext_wheels(
+    wau8_ext_wheels_t * pxwheels,
+    const wau8_wheels_t * pwheels);
+void wau8_set_ext_wheels(
+    wau8_context_t * pcontext,
+    const wau8_ext_wheels_t * pxwheels);
+void wau8_make_fused_wheels(
+    wau8_fused_wheels_t * pfwheels,
+    const wau8_wheels_t * pwheels);
+void wau8_set_fused_wheels(
+    wau8_context_t * pcontext,
+    const wau8_fused_wheels_t * pfwheels);
 void wau8_advance(wau8_context_t * pcontext);
 uint8_t wau8_get_val(const wau8_context_t * pcontext);
+void wau8_seek(wau8_context_t * pcontext, const uint64_t offset);
+uint64_t wau8_get_offset(const wau8_context_t * pcontext);
+
+wau8_backend_t wau8_set_backend(const wau8_backend_t backend);
+wau8_backend_t wau8_get_backend(void);
+int wau8_backend_available(const wau8_backend_t backend);
+const char * wau8_backend_name(const wau8_backend_t backend);
+
+void wau8_keystream(wau8_context_t * pcontext, uint8_t * pbuff, const size_t sz);
+void wau8_xor(
+    wau8_context_t * pcontext,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz);
+void wau8_xor_inplace(wau8_context_t * pcontext, uint8_t * pbuff, const size_t sz);
+size_t wau8_xorv(
+    wau8_context_t * pcontext,
+    const wau8_iovec_t * psrc_iov,
+    const size_t src_count,
+    const wau8_iovec_t * pdst_iov,
+    const size_t dst_count);
+size_t wau8_xorv_inplace(
+    wau8_context_t * pcontext,
+    const wau8_iovec_t * piov,
+    const size_t count);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,505 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#include <stdlib.h>
+#include <string.h>
+#include "wau8_arc.h"
+#include "wau8_session.h"
+#include "wau8_util.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static const uint8_t HEADER_MAGIC[7] = { 'W', 'A', 'U', '8', 'A', 'R', 'C' };
+static const uint8_t FOOTER_MAGIC[7] = { 'W', 'A', 'U', '8', 'I', 'D', 'X' };
+
+#define INDEX_START         (64U)
+
+
+static void put_u32(uint8_t * p, const uint32_t val)
+{
+    unsigned int ii;
+    for (ii = 0; ii < 4U; ii++)
+    {
+        p[ii] = (uint8_t)(val >> (8U * ii));
+    }
+}
+
+
+static uint32_t get_u32(const uint8_t * p)
+{
+    uint32_t val = 0U;
+    unsigned int ii;
+    for (ii = 0; ii < 4U; ii++)
+    {
+        val |= ((uint32_t)p[ii]) << (8U * ii);
+    }
+    return val;
+}
+
+
+static void put_u64(uint8_t * p, const uint64_t val)
+{
+    unsigned int ii;
+    for (ii = 0; ii < 8U; ii++)
+    {
+        p[ii] = (uint8_t)(val >> (8U * ii));
+    }
+}
+
+
+static uint64_t get_u64(const uint8_t * p)
+{
+    uint64_t val = 0U;
+    unsigned int ii;
+    for (ii = 0; ii < 8U; ii++)
+    {
+        val |= ((uint64_t)p[ii]) << (8U * ii);
+    }
+    return val;
+}
+
+
+// check value of a stored block
+// FNV-1a taking 8 bytes at a time so it keeps up with the decryption
+// (words are taken little-endian so the value is the same everywhere)
+static uint64_t block_check(const uint8_t * p, const size_t sz)
+{
+    uint64_t hash = WAU8_FNV_OFFSET_BASIS;
+    size_t jj;
+
+    for (jj = 0; (sz - jj) >= 8U; jj += 8U)
+    {
+        uint64_t w;
+        memcpy(&w, p + jj, 8U);
+        hash ^= WAU8_LE64(w);
+        hash *= WAU8_FNV_PRIME;
+    }
+    for (; jj < sz; jj++)
+    {
+        hash ^= p[jj];
+        hash *= WAU8_FNV_PRIME;
+    }
+    return hash ^ (uint64_t)sz;
+}
+
+
+// encrypts and writes out the block buffer and adds it to the index
+static wau8_arc_status_t flush_block(wau8_arc_writer_t * pwriter)
+{
+    wau8_arc_entry_t * pe;
+
+    if (pwriter->count == pwriter->capacity)
+    {
+        uint64_t capacity = pwriter->capacity * 2U;
+        wau8_arc_entry_t * p = (wau8_arc_entry_t *)realloc(
+            pwriter->pindex, (size_t)capacity * sizeof(wau8_arc_entry_t));
+        if (p == NULL)
+        {
+            return WAU8_ARC_NO_MEMORY;
+        }
+        pwriter->pindex = p;
+        pwriter->capacity = capacity;
+    }
+
+    wau8_xor_inplace(&pwriter->con, pwriter->pblock, pwriter->block_len);
+    pe = &pwriter->pindex[pwriter->count];
+    pe->pos = pwriter->file_pos;
+    pe->sz = (uint32_t)pwriter->block_len;
+    pe->check = block_check(pwriter->pblock, pwriter->block_len);
+
+    if (pwriter->write_fn(pwriter->parg, pe->pos, pwriter->pblock, pwriter->block_len) != 0)
+    {
+        return WAU8_ARC_IO;
+    }
+
+    pwriter->count++;
+    pwriter->file_pos += pwriter->block_len;
+    pwriter->data_sz += pwriter->block_len;
+    pwriter->block_len = 0U;
+    return WAU8_ARC_OK;
+}
+
+
+// starts an archive and writes its header
+// the data is encrypted from the context's key and current offset
+// block_sz of 0 uses WAU8_ARC_BLOCK_SZ
+// wau8_arc_writer_finish must be called to complete the archive
+// (or to free the writer after an error)
+wau8_arc_status_t wau8_arc_writer_init(
+    wau8_arc_writer_t * pwriter,
+    const wau8_context_t * pcontext,
+    const uint32_t block_sz,
+    const uint64_t key_id,
+    wau8_arc_write_fn_t write_fn,
+    void * parg)
+{
+    uint8_t hdr[WAU8_ARC_HEADER_SZ];
+
+    memset(pwriter, 0, sizeof(*pwriter));
+    pwriter->con = *pcontext;
+    pwriter->write_fn = write_fn;
+    pwriter->parg = parg;
+    pwriter->block_sz = (block_sz == 0U) ? WAU8_ARC_BLOCK_SZ : block_sz;
+    pwriter->file_pos = WAU8_ARC_HEADER_SZ;
+    pwriter->capacity = INDEX_START;
+    pwriter->pblock = (uint8_t *)malloc(pwriter->block_sz);
+    pwriter->pindex = (wau8_arc_entry_t *)malloc(INDEX_START * sizeof(wau8_arc_entry_t));
+    if ((pwriter->pblock == NULL) || (pwriter->pindex == NULL))
+    {
+        return WAU8_ARC_NO_MEMORY;
+    }
+
+    memset(hdr, 0, sizeof(hdr));
+    memcpy(hdr, HEADER_MAGIC, sizeof(HEADER_MAGIC));
+    hdr[7] = (uint8_t)WAU8_ARC_VERSION;
+    put_u32(hdr + 8U, pwriter->block_sz);
+    hdr[12] = (uint8_t)WAU8_KEY_SZ;
+    put_u64(hdr + 16U, wau8_wheels_id(pcontext->pwheels));
+    put_u64(hdr + 24U, key_id);
+    put_u64(hdr + 32U, wau8_get_offset(pcontext));
+
+    return (write_fn(parg, 0U, hdr, sizeof(hdr)) == 0) ? WAU8_ARC_OK : WAU8_ARC_IO;
+}
+
+
+// adds data to the archive, whole blocks are written as they fill
+wau8_arc_status_t wau8_arc_write(
+    wau8_arc_writer_t * pwriter,
+    const uint8_t * psrc,
+    const size_t sz)
+{
+    size_t done = 0U;
+
+    while (done < sz)
+    {
+        size_t room = pwriter->block_sz - pwriter->block_len;
+        size_t n = ((sz - done) < room) ? (sz - done) : room;
+
+        memcpy(pwriter->pblock + pwriter->block_len, psrc + done, n);
+        pwriter->block_len += n;
+        done += n;
+
+        if (pwriter->block_len == pwriter->block_sz)
+        {
+            wau8_arc_status_t status = flush_block(pwriter);
+            if (status != WAU8_ARC_OK)
+            {
+                return status;
+            }
+        }
+    }
+
+    return WAU8_ARC_OK;
+}
+
+
+// writes the last block, the index and the footer, and frees the writer
+wau8_arc_status_t wau8_arc_writer_finish(wau8_arc_writer_t * pwriter)
+{
+    wau8_arc_status_t status = WAU8_ARC_OK;
+    uint8_t * pbuff = NULL;
+
+    if ((pwriter->pblock == NULL) || (pwriter->pindex == NULL))
+    {
+        status = WAU8_ARC_NO_MEMORY;
+    }
+    else if (pwriter->block_len > 0U)
+    {
+        status = flush_block(pwriter);
+    }
+
+    if (status == WAU8_ARC_OK)
+    {
+        const size_t index_sz = (size_t)pwriter->count * WAU8_ARC_ENTRY_SZ;
+        pbuff = (uint8_t *)calloc(index_sz + WAU8_ARC_FOOTER_SZ, 1U);
+        status = (pbuff == NULL) ? WAU8_ARC_NO_MEMORY : WAU8_ARC_OK;
+    }
+
+    if (status == WAU8_ARC_OK)
+    {
+        uint8_t * p = pbuff;
+        uint64_t ii;
+
+        for (ii = 0; ii < pwriter->count; ii++)
+        {
+            put_u64(p, pwriter->pindex[ii].pos);
+            put_u32(p + 8U, pwriter->pindex[ii].sz);
+            put_u64(p + 16U, pwriter->pindex[ii].check);
+            p += WAU8_ARC_ENTRY_SZ;
+        }
+
+        memcpy(p, FOOTER_MAGIC, sizeof(FOOTER_MAGIC));
+        p[7] = (uint8_t)WAU8_ARC_VERSION;
+        put_u64(p + 8U, pwriter->count);
+        put_u64(p + 16U, pwriter->file_pos);
+        put_u64(p + 24U, pwriter->data_sz);
+
+        if (pwriter->write_fn(pwriter->parg, pwriter->file_pos, pbuff,
+            (size_t)(p - pbuff) + WAU8_ARC_FOOTER_SZ) != 0)
+        {
+            status = WAU8_ARC_IO;
+        }
+    }
+
+    free(pbuff);
+    free(pwriter->pblock);
+    free(pwriter->pindex);
+    pwriter->pblock = NULL;
+    pwriter->pindex = NULL;
+    return status;
+}
+
+
+// reads the header, footer and index of an archive of file_sz bytes
+// and checks that they fit together
+wau8_arc_status_t wau8_arc_reader_open(
+    wau8_arc_reader_t * preader,
+    wau8_arc_read_fn_t read_fn,
+    void * parg,
+    const uint64_t file_sz)
+{
+    uint8_t hdr[WAU8_ARC_HEADER_SZ];
+    uint8_t ftr[WAU8_ARC_FOOTER_SZ];
+    uint8_t * pbuff;
+    uint64_t index_pos;
+    uint64_t expect_pos = WAU8_ARC_HEADER_SZ;
+    uint64_t total = 0U;
+    uint64_t ii;
+
+    memset(preader, 0, sizeof(*preader));
+    preader->read_fn = read_fn;
+    preader->parg = parg;
+
+    if (file_sz < (WAU8_ARC_HEADER_SZ + WAU8_ARC_FOOTER_SZ))
+    {
+        return WAU8_ARC_BAD_FORMAT;
+    }
+    if ((read_fn(parg, 0U, hdr, sizeof(hdr)) != 0) ||
+        (read_fn(parg, file_sz - WAU8_ARC_FOOTER_SZ, ftr, sizeof(ftr)) != 0))
+    {
+        return WAU8_ARC_IO;
+    }
+
+    preader->block_sz = get_u32(hdr + 8U);
+    preader->wheels_id = get_u64(hdr + 16U);
+    preader->key_id = get_u64(hdr + 24U);
+    preader->base_offset = get_u64(hdr + 32U);
+    preader->count = get_u64(ftr + 8U);
+    preader->data_sz = get_u64(ftr + 24U);
+    index_pos = get_u64(ftr + 16U);
+
+    // the index sits between the last block and the footer
+    // and there is one block for every block_sz bytes of data
+    if ((memcmp(hdr, HEADER_MAGIC, sizeof(HEADER_MAGIC)) != 0) ||
+        (memcmp(ftr, FOOTER_MAGIC, sizeof(FOOTER_MAGIC)) != 0) ||
+        (hdr[7] != WAU8_ARC_VERSION) || (ftr[7] != WAU8_ARC_VERSION) ||
+        (hdr[12] != WAU8_KEY_SZ) ||
+        (preader->block_sz == 0U) ||
+        (index_pos > file_sz) ||
+        (preader->count > ((file_sz - index_pos) / WAU8_ARC_ENTRY_SZ)) ||
+        ((index_pos + (preader->count * WAU8_ARC_ENTRY_SZ) + WAU8_ARC_FOOTER_SZ) != file_sz) ||
+        (preader->count != ((preader->data_sz / preader->block_sz) +
+            (((preader->data_sz % preader->block_sz) != 0U) ? 1U : 0U))))
+    {
+        return WAU8_ARC_BAD_FORMAT;
+    }
+
+    pbuff = (uint8_t *)malloc((size_t)preader->count * WAU8_ARC_ENTRY_SZ + 1U);
+    preader->pindex = (wau8_arc_entry_t *)malloc((size_t)preader->count * sizeof(wau8_arc_entry_t) + 1U);
+    if ((pbuff == NULL) || (preader->pindex == NULL))
+    {
+        free(pbuff);
+        wau8_arc_reader_close(preader);
+        return WAU8_ARC_NO_MEMORY;
+    }
+    if (read_fn(parg, index_pos, pbuff, (size_t)preader->count * WAU8_ARC_ENTRY_SZ) != 0)
+    {
+        free(pbuff);
+        wau8_arc_reader_close(preader);
+        return WAU8_ARC_IO;
+    }
+
+    // blocks are full size except maybe the last, one after another
+    for (ii = 0; ii < preader->count; ii++)
+    {
+        wau8_arc_entry_t * pe = &preader->pindex[ii];
+        uint64_t sz = preader->data_sz - (ii * preader->block_sz);
+
+        pe->pos = get_u64(pbuff + (ii * WAU8_ARC_ENTRY_SZ));
+        pe->sz = get_u32(pbuff + (ii * WAU8_ARC_ENTRY_SZ) + 8U);
+        pe->check = get_u64(pbuff + (ii * WAU8_ARC_ENTRY_SZ) + 16U);
+        if ((pe->pos != expect_pos) ||
+            (pe->sz != ((sz < preader->block_sz) ? sz : preader->block_sz)))
+        {
+            free(pbuff);
+            wau8_arc_reader_close(preader);
+            return WAU8_ARC_BAD_FORMAT;
+        }
+        expect_pos += pe->sz;
+        total += pe->sz;
+    }
+
+    // and together they hold exactly the data
+    free(pbuff);
+    if ((expect_pos != index_pos) || (total != preader->data_sz))
+    {
+        wau8_arc_reader_close(preader);
+        return WAU8_ARC_BAD_FORMAT;
+    }
+    return WAU8_ARC_OK;
+}
+
+
+// reads, checks and decrypts the part of one block that falls in
+// the range pos to pos + sz of the data
+// a whole block is read straight into the destination, a block only
+// partly in the range is read whole into a temporary buffer so its
+// check value can be tested
+static wau8_arc_status_t read_block(
+    const wau8_arc_reader_t * preader,
+    const wau8_context_t * pcontext,
+    const uint64_t block,
+    const uint64_t pos,
+    uint8_t * pdst,
+    const size_t sz)
+{
+    const wau8_arc_entry_t * pe = &preader->pindex[block];
+    const uint64_t start = block * preader->block_sz;
+    const uint64_t lo = (start > pos) ? start : pos;
+    const uint64_t hi = ((start + pe->sz) < (pos + sz)) ? (start + pe->sz) : (pos + sz);
+    uint8_t * pout = pdst + (lo - pos);
+    uint8_t * pbuff = pout;
+    wau8_context_t con = *pcontext;
+    wau8_arc_status_t status = WAU8_ARC_OK;
+
+    if ((lo != start) || (hi != (start + pe->sz)))
+    {
+        pbuff = (uint8_t *)malloc(pe->sz);
+        if (pbuff == NULL)
+        {
+            return WAU8_ARC_NO_MEMORY;
+        }
+    }
+
+    if (preader->read_fn(preader->parg, pe->pos, pbuff, pe->sz) != 0)
+    {
+        status = WAU8_ARC_IO;
+    }
+    else if (block_check(pbuff, pe->sz) != pe->check)
+    {
+        status = WAU8_ARC_BAD_BLOCK;
+    }
+    else
+    {
+        wau8_seek(&con, preader->base_offset + lo);
+        wau8_xor(&con, pbuff + (lo - start), pout, (size_t)(hi - lo));
+    }
+
+    if (pbuff != pout)
+    {
+        free(pbuff);
+    }
+    return status;
+}
+
+
+// decrypts sz bytes of the data starting at pos into pdst
+// pcontext has the archive's wheels (and any extended or fused wheels)
+// and its key set, it is only copied
+// the blocks of the range are shared out between nthreads threads
+// (0 uses the OpenMP default), so the read callback must be safe to
+// call from several threads at once unless nthreads is 1
+// the reader isn't changed, so several reads can share it
+// (as long as the read callback is safe to call from all of them)
+wau8_arc_status_t wau8_arc_read(
+    const wau8_arc_reader_t * preader,
+    const wau8_context_t * pcontext,
+    const uint64_t pos,
+    uint8_t * pdst,
+    const size_t sz,
+    const int nthreads)
+{
+    wau8_arc_status_t status = WAU8_ARC_OK;
+    ptrdiff_t first;
+    ptrdiff_t last;
+    ptrdiff_t ii;
+    int nt = 1;
+
+    if ((pos > preader->data_sz) || (sz > (preader->data_sz - pos)))
+    {
+        return WAU8_ARC_RANGE;
+    }
+    if (sz == 0U)
+    {
+        return WAU8_ARC_OK;
+    }
+
+    // checked every time, the caller may have loaded other wheels
+    // into the same table since the last call
+    if (wau8_wheels_id(pcontext->pwheels) != preader->wheels_id)
+    {
+        return WAU8_ARC_WRONG_WHEELS;
+    }
+
+#ifdef _OPENMP
+    nt = (nthreads > 0) ? nthreads : omp_get_max_threads();
+#else
+    (void)nthreads;
+    (void)nt;
+#endif
+
+    first = (ptrdiff_t)(pos / preader->block_sz);
+    last = (ptrdiff_t)((pos + sz - 1U) / preader->block_sz);
+
+#pragma omp parallel for schedule(dynamic) num_threads(nt)
+    for (ii = first; ii <= last; ii++)
+    {
+        wau8_arc_status_t st = read_block(preader, pcontext, (uint64_t)ii, pos, pdst, sz);
+        if (st != WAU8_ARC_OK)
+        {
+#pragma omp critical(wau8_arc_status)
+            {
+                if (status == WAU8_ARC_OK)
+                {
+                    status = st;
+                }
+            }
+        }
+    }
+
+    return status;
+}
+
+
+void wau8_arc_reader_close(wau8_arc_reader_t * preader)
+{
+    free(preader->pindex);
+    preader->pindex = NULL;
+    preader->count = 0U;
+}
@@ -0,0 +1,148 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#ifndef WAU8_ARC_H_
+#define WAU8_ARC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "wau8.h"
+
+// encrypted container (archive) format
+//
+// header      WAU8_ARC_HEADER_SZ bytes
+//             magic "WAU8ARC", version, block size, key size,
+//             wheels id, key id, keystream offset of the first data byte
+// blocks      the data cut into blocks of the block size (the last one
+//             may be shorter), each encrypted at its own keystream offset
+// index       one entry per block: where it is in the file, its length,
+//             and a check value of the stored bytes
+// footer      WAU8_ARC_FOOTER_SZ bytes at the very end
+//             magic "WAU8IDX", version, block count, index position,
+//             total data size
+//
+// every field is little-endian
+// since each block's keystream offset comes from its position alone,
+// any range of the data can be decrypted without reading the rest
+// of the file, and the blocks of a range can be done in parallel
+// the key id is the caller's and is only stored, the key itself is not
+// the check value catches damaged or truncated blocks, it is not a MAC
+
+#define WAU8_ARC_VERSION        (1U)
+#define WAU8_ARC_HEADER_SZ      (64U)
+#define WAU8_ARC_FOOTER_SZ      (32U)
+#define WAU8_ARC_ENTRY_SZ       (24U)
+#define WAU8_ARC_BLOCK_SZ       (1U << 20U)
+
+typedef enum
+{
+    WAU8_ARC_OK = 0,
+    WAU8_ARC_IO,            // read or write callback failed
+    WAU8_ARC_NO_MEMORY,
+    WAU8_ARC_BAD_FORMAT,    // not an archive or from a different geometry
+    WAU8_ARC_WRONG_WHEELS,  // written with a different set of wheels
+    WAU8_ARC_BAD_BLOCK,     // block doesn't match its check value
+    WAU8_ARC_RANGE,         // range goes past the end of the data
+} wau8_arc_status_t;
+
+// file access supplied by the caller, return 0 if all sz bytes were done
+// a writer only appends: each write starts where the last one ended,
+// so the output doesn't need to be seekable
+// reads may come from several threads at once when decrypting in parallel
+typedef int (*wau8_arc_write_fn_t)(void * parg, const uint64_t pos, const uint8_t * p, const size_t sz);
+typedef int (*wau8_arc_read_fn_t)(void * parg, const uint64_t pos, uint8_t * p, const size_t sz);
+
+typedef struct
+{
+    uint64_t pos;           // file position
+    uint32_t sz;
+    uint64_t check;
+} wau8_arc_entry_t;
+
+typedef struct
+{
+    wau8_context_t con;
+    wau8_arc_write_fn_t write_fn;
+    void * parg;
+    uint8_t * pblock;
+    size_t block_len;
+    uint32_t block_sz;
+    uint64_t file_pos;
+    uint64_t data_sz;
+    wau8_arc_entry_t * pindex;
+    uint64_t count;
+    uint64_t capacity;
+} wau8_arc_writer_t;
+
+typedef struct
+{
+    wau8_arc_read_fn_t read_fn;
+    void * parg;
+    uint32_t block_sz;
+    uint64_t wheels_id;
+    uint64_t key_id;
+    uint64_t base_offset;   // keystream offset of the first data byte
+    uint64_t data_sz;
+    wau8_arc_entry_t * pindex;
+    uint64_t count;
+} wau8_arc_reader_t;
+
+
+wau8_arc_status_t wau8_arc_writer_init(
+    wau8_arc_writer_t * pwriter,
+    const wau8_context_t * pcontext,
+    const uint32_t block_sz,
+    const uint64_t key_id,
+    wau8_arc_write_fn_t write_fn,
+    void * parg);
+wau8_arc_status_t wau8_arc_write(
+    wau8_arc_writer_t * pwriter,
+    const uint8_t * psrc,
+    const size_t sz);
+wau8_arc_status_t wau8_arc_writer_finish(wau8_arc_writer_t * pwriter);
+
+wau8_arc_status_t wau8_arc_reader_open(
+    wau8_arc_reader_t * preader,
+    wau8_arc_read_fn_t read_fn,
+    void * parg,
+    const uint64_t file_sz);
+wau8_arc_status_t wau8_arc_read(
+    const wau8_arc_reader_t * preader,
+    const wau8_context_t * pcontext,
+    const uint64_t pos,
+    uint8_t * pdst,
+    const size_t sz,
+    const int nthreads);
+void wau8_arc_reader_close(wau8_arc_reader_t * preader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WAU8_ARC_H_
@@ -0,0 +1,80 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#include "wau8_batch.h"
+
+
+// encrypts/decrypts many short messages that each have their own key
+// the context supplies the wheels (and any extended or fused wheels)
+// each message gives the same result as wau8_set_key followed by wau8_xor
+// and the context is left as it would be after the last message
+//
+// extended wheels only depend on the wheels, not the key, so one table
+// serves every message in the batch
+// if the context doesn't have one and the batch is big enough to pay for
+// building it, a temporary one is used so short messages get the vector
+// kernels instead of a byte at a time
+// (interleaving messages in lanes with vector gathers was tried but is
+// several times slower than giving each message the contiguous loads)
+void wau8_xor_batch(
+    wau8_context_t * pcontext,
+    const wau8_batch_item_t * pitems,
+    const size_t count)
+{
+    wau8_ext_wheels_t xwheels;
+    size_t total = 0U;
+    size_t ii;
+    int is_temp_ext = 0;
+
+    if ((pcontext->pxwheels == NULL) &&
+        (wau8_get_backend() != WAU8_BACKEND_SCALAR))
+    {
+        for (ii = 0; ii < count; ii++)
+        {
+            total += pitems[ii].sz;
+        }
+
+        if (total >= sizeof(xwheels))
+        {
+            wau8_make_ext_wheels(&xwheels, pcontext->pwheels);
+            wau8_set_ext_wheels(pcontext, &xwheels);
+            is_temp_ext = 1;
+        }
+    }
+
+    for (ii = 0; ii < count; ii++)
+    {
+        const wau8_batch_item_t * pitem = &pitems[ii];
+        wau8_set_key(pcontext, &pitem->key);
+        wau8_xor(pcontext, pitem->psrc, pitem->pdst, pitem->sz);
+    }
+
+    if (is_temp_ext)
+    {
+        wau8_set_ext_wheels(pcontext, NULL);
+    }
+}
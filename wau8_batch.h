@@ -0,0 +1,57 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#ifndef WAU8_BATCH_H_
+#define WAU8_BATCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "wau8.h"
+
+// one message to encrypt/decrypt with its own key
+// source and destination may be the same buffer
+typedef struct
+{
+    uint8_t key[WAU8_KEY_SZ];
+    const uint8_t * psrc;
+    uint8_t * pdst;
+    size_t sz;
+} wau8_batch_item_t;
+
+
+void wau8_xor_batch(
+    wau8_context_t * pcontext,
+    const wau8_batch_item_t * pitems,
+    const size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WAU8_BATCH_H_
@@ -0,0 +1,251 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#include <string.h>
+#include "wau8_bs.h"
+#include "wau8_util.h"
+
+
+// transposes a 64x64 bit matrix in place (bit j of word i swaps with
+// bit i of word j) by swapping 32x32 blocks, then 16x16 blocks, and so on
+// with m[k] holding 8 bytes of lane k this gives m[8t + b] holding bit b
+// of byte t of every lane, i.e. the bit planes for 8 steps, and it is
+// its own inverse so the same call turns planes back into lane bytes
+void wau8_bs_transpose(uint64_t m[64])
+{
+    uint64_t mask = 0x00000000FFFFFFFFULL;
+    unsigned int j;
+    unsigned int k;
+
+    for (j = 32U; j != 0U; j >>= 1U, mask ^= (mask << j))
+    {
+        for (k = 0U; k < 64U; k = ((k | j) + 1U) & ~j)
+        {
+            uint64_t t = ((m[k] >> j) ^ m[k | j]) & mask;
+            m[k] ^= (t << j);
+            m[k | j] ^= t;
+        }
+    }
+}
+
+
+// fills the planes of one wheel
+// row r holds the wheel's values for every lane r steps after
+// the lane's starting position, 8 rows at a time by transposing
+// 8 consecutive wheel values from each lane
+static void build_planes(
+    uint64_t * pplanes,
+    const uint8_t * const pwheel[WAU8_BS_LANES],
+    const unsigned int pos[WAU8_BS_LANES],
+    const unsigned int sz)
+{
+    unsigned int r0;
+    unsigned int kk;
+    unsigned int tt;
+
+    for (r0 = 0U; r0 < WAU8_BS_ROWS(sz); r0 += WAU8_BS_STEPS)
+    {
+        uint64_t * m = pplanes + (r0 * 8U);
+
+        for (kk = 0U; kk < WAU8_BS_LANES; kk++)
+        {
+            unsigned int p = (pos[kk] + r0) % sz;
+            uint64_t val = 0U;
+
+            for (tt = 0U; tt < WAU8_BS_STEPS; tt++)
+            {
+                val |= (uint64_t)pwheel[kk][p] << (8U * tt);
+                p = ((p + 1U) == sz) ? 0U : (p + 1U);
+            }
+            m[kk] = val;
+        }
+
+        wau8_bs_transpose(m);
+    }
+}
+
+
+// sets up the lanes from count contexts (up to WAU8_BS_LANES, more are ignored)
+// each lane starts where its context is, and may have its own wheels
+// lanes past count repeat the first context
+// returns 0 or -1 if there are no contexts (the engine is left alone)
+#define GEN_BS_BUILD(nm, ix, sz) \
+    for (kk = 0U; kk < WAU8_BS_LANES; kk++) \
+    { \
+        pwheel[kk] = pc[kk]->pwheels->nm; \
+        pos[kk] = pc[kk]->pos##nm; \
+    } \
+    build_planes(pbs->nm, pwheel, pos, sz); \
+    pbs->pos[ix] = 0U;
+
+int wau8_bs_init(wau8_bs_t * pbs, const wau8_context_t * pcontexts, const size_t count)
+{
+    const wau8_context_t * pc[WAU8_BS_LANES];
+    const uint8_t * pwheel[WAU8_BS_LANES];
+    unsigned int pos[WAU8_BS_LANES];
+    unsigned int kk;
+
+    if ((pcontexts == NULL) || (count == 0U))
+    {
+        return -1;
+    }
+
+    for (kk = 0U; kk < WAU8_BS_LANES; kk++)
+    {
+        pc[kk] = &pcontexts[(kk < count) ? kk : 0U];
+    }
+
+    WAU8_WHEELS(GEN_BS_BUILD)
+    return 0;
+}
+
+
+// sets up the lanes as 64 places in one keystream
+// lane k starts stride x k bytes after the context's offset
+void wau8_bs_init_offsets(
+    wau8_bs_t * pbs,
+    const wau8_context_t * pcontext,
+    const uint64_t stride)
+{
+    wau8_context_t lanes[WAU8_BS_LANES];
+    unsigned int kk;
+
+    for (kk = 0U; kk < WAU8_BS_LANES; kk++)
+    {
+        lanes[kk] = *pcontext;
+        wau8_seek(&lanes[kk], pcontext->offset + (stride * kk));
+    }
+
+    (void)wau8_bs_init(pbs, lanes, WAU8_BS_LANES);
+}
+
+
+// makes the next 8 keystream bytes of every lane
+// lanes[k] holds lane k's bytes little-endian
+#define GEN_BS_STEP(nm, ix, sz) \
+    { \
+        const uint64_t * p = &pbs->nm[pbs->pos[ix] * 8U]; \
+        for (ii = 0U; ii < 64U; ii++) \
+        { \
+            lanes[ii] ^= p[ii]; \
+        } \
+        pbs->pos[ix] = (pbs->pos[ix] + WAU8_BS_STEPS) % (sz); \
+    }
+
+void wau8_bs_block(wau8_bs_t * pbs, uint64_t lanes[WAU8_BS_LANES])
+{
+    unsigned int ii;
+
+    memset(lanes, 0, WAU8_BS_LANES * sizeof(uint64_t));
+    WAU8_WHEELS(GEN_BS_STEP)
+    wau8_bs_transpose(lanes);
+}
+
+
+// encrypts/decrypts sz bytes of every lane, each from its own source
+// buffer into its own destination buffer (which may be the same)
+// lanes with a NULL source are skipped but their keystream still moves on
+// the lanes move in blocks of 8 bytes, so they only carry on correctly
+// into a following call if sz is a multiple of 8
+void wau8_bs_xor(
+    wau8_bs_t * pbs,
+    const uint8_t * const psrc[WAU8_BS_LANES],
+    uint8_t * const pdst[WAU8_BS_LANES],
+    const size_t sz)
+{
+    uint64_t lanes[WAU8_BS_LANES];
+    size_t jj;
+    unsigned int kk;
+
+    for (jj = 0U; jj < sz; jj += WAU8_BS_STEPS)
+    {
+        const size_t n = ((sz - jj) < WAU8_BS_STEPS) ? (sz - jj) : WAU8_BS_STEPS;
+
+        wau8_bs_block(pbs, lanes);
+        for (kk = 0U; kk < WAU8_BS_LANES; kk++)
+        {
+            uint64_t val;
+            uint64_t ks = WAU8_LE64(lanes[kk]);
+
+            if (psrc[kk] == NULL)
+            {
+                continue;
+            }
+            if (n == WAU8_BS_STEPS)
+            {
+                memcpy(&val, psrc[kk] + jj, sizeof(val));
+                val ^= ks;
+                memcpy(pdst[kk] + jj, &val, sizeof(val));
+            }
+            else
+            {
+                size_t tt;
+                for (tt = 0U; tt < n; tt++)
+                {
+                    pdst[kk][jj + tt] = psrc[kk][jj + tt] ^ (uint8_t)(lanes[kk] >> (8U * tt));
+                }
+            }
+        }
+    }
+}
+
+
+// encrypts/decrypts one buffer like wau8_xor but with the bitsliced engine
+// the buffer is cut into 64 runs of a whole number of blocks, one per lane,
+// and whatever is left at the end goes through wau8_xor
+// pbs is only working space (it is big, so the caller provides it)
+void wau8_xor_bs(
+    wau8_bs_t * pbs,
+    wau8_context_t * pcontext,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz)
+{
+    const size_t lane_sz = (sz / WAU8_BS_LANES) & ~(size_t)(WAU8_BS_STEPS - 1U);
+    const uint64_t start = pcontext->offset;
+    const uint8_t * plane_src[WAU8_BS_LANES];
+    uint8_t * plane_dst[WAU8_BS_LANES];
+    unsigned int kk;
+
+    if (lane_sz > 0U)
+    {
+        for (kk = 0U; kk < WAU8_BS_LANES; kk++)
+        {
+            plane_src[kk] = psrc + (lane_sz * kk);
+            plane_dst[kk] = pdst + (lane_sz * kk);
+        }
+        wau8_bs_init_offsets(pbs, pcontext, lane_sz);
+        wau8_bs_xor(pbs, plane_src, plane_dst, lane_sz);
+        wau8_seek(pcontext, start + (lane_sz * WAU8_BS_LANES));
+    }
+
+    wau8_xor(
+        pcontext,
+        psrc + (lane_sz * WAU8_BS_LANES),
+        pdst + (lane_sz * WAU8_BS_LANES),
+        sz - (lane_sz * WAU8_BS_LANES));
+}
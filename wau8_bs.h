@@ -0,0 +1,90 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#ifndef WAU8_BS_H_
+#define WAU8_BS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "wau8.h"
+
+// bitsliced keystream engine, 64 lanes in plain 64-bit integers
+//
+// each lane is a keystream of its own (a context's key, offset and wheels)
+// the wheels are turned into bit planes when the engine is set up:
+// for every wheel and every step, 8 words holding bit b of the value
+// that wheel gives each lane at that step (bit k of a word is lane k)
+// a step for all 64 lanes is then 8 words per wheel XORed together,
+// with no per-lane table lookups at all
+// steps are made 8 at a time (64 words), and one 64x64 bit transpose
+// turns them into 8 keystream bytes for each lane
+// the planes take (size + 8 or so) x 64 bytes per wheel, about 130 KB for the
+// default geometry, and setting them up costs about as much as 40 KB of
+// scalar wau8_xor(), so the engine only pays off for long runs
+// (a few hundred KB and up in one buffer, or KBs per lane)
+
+#define WAU8_BS_LANES           (64U)
+#define WAU8_BS_STEPS           (8U)
+
+// rows of planes kept per wheel, enough to read 8 rows from any position
+#define WAU8_BS_ROWS(sz)        (((((sz) + 7U) / 8U) + 1U) * 8U)
+
+#define WAU8_GEN_BS_PLANES(nm, ix, sz)  uint64_t nm[WAU8_BS_ROWS(sz) * 8U];
+
+typedef struct
+{
+    WAU8_WHEELS(WAU8_GEN_BS_PLANES)
+    unsigned int pos[WAU8_KEY_SZ];  // row each wheel's next step starts at
+} wau8_bs_t;
+
+
+void wau8_bs_transpose(uint64_t m[64]);
+int wau8_bs_init(wau8_bs_t * pbs, const wau8_context_t * pcontexts, const size_t count);
+void wau8_bs_init_offsets(
+    wau8_bs_t * pbs,
+    const wau8_context_t * pcontext,
+    const uint64_t stride);
+void wau8_bs_block(wau8_bs_t * pbs, uint64_t lanes[WAU8_BS_LANES]);
+void wau8_bs_xor(
+    wau8_bs_t * pbs,
+    const uint8_t * const psrc[WAU8_BS_LANES],
+    uint8_t * const pdst[WAU8_BS_LANES],
+    const size_t sz);
+void wau8_xor_bs(
+    wau8_bs_t * pbs,
+    wau8_context_t * pcontext,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WAU8_BS_H_
@@ -0,0 +1,735 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "wau8_check.h"
+#include "wau8_ref.h"
+#include "wau8_par.h"
+#include "wau8_batch.h"
+#include "wau8_bs.h"
+#include "wau8_reg.h"
+#include "wau8_util.h"
+
+// buffers are offset by up to this much to try every vector alignment
+#define ALIGN_SPAN      (64U)
+
+// most pieces a message is split into for wau8_xor and wau8_xorv
+#define MAX_PIECES      (8U)
+
+// messages in a batch
+#define BATCH_ITEMS     (4U)
+
+// offsets stay below 2^63 so offset + length never wraps
+#define OFFSET_MASK     (0x7FFFFFFFFFFFFFFFULL)
+
+// registry capacity, not a whole number of chunks
+#define REG_SETS        (300U)
+
+// add/bind/release rounds per thread in the registry stress
+#define REG_ROUNDS      (2000U)
+
+
+// one random case
+typedef struct
+{
+    uint8_t key[WAU8_KEY_SZ];
+    uint64_t offset;
+    size_t sz;
+    const uint8_t * psrc;
+    const uint8_t * pref;
+    uint8_t * pdst;
+} check_case_t;
+
+static wau8_wheels_t wheels;
+static wau8_ext_wheels_t xwheels;
+static wau8_fused_wheels_t fwheels;
+static wau8_bs_t bs;
+static wau8w_wheels_t wwheels;
+static wau8_wheels_t reg_wheels[4];
+
+
+#if !defined(WAU8_GEOMETRY)
+
+// known-answer vectors for the default geometry
+// keystream (plaintext all 0) for wheels from wau8_make_wheels(seed)
+// the second key rolls over to all 0s after one byte
+// so its keystream is the first one a byte later
+typedef struct
+{
+    uint64_t seed;
+    uint8_t key[WAU8_KEY_SZ];
+    uint64_t offset;
+    uint8_t val[16];
+} check_kat_t;
+
+static const check_kat_t KATS[] =
+{
+    {
+        1U, { 0, 0, 0, 0, 0, 0, 0, 0 }, 0U,
+        { 0xA8,0xF1,0x0E,0xA0,0x28,0x10,0x47,0x14, 0x6D,0x96,0x7C,0x5E,0x86,0x97,0x70,0xB4 },
+    },
+    {
+        1U, { 255,252,250,248,246,244,240,238 }, 0U,
+        { 0x8D,0xA8,0xF1,0x0E,0xA0,0x28,0x10,0x47, 0x14,0x6D,0x96,0x7C,0x5E,0x86,0x97,0x70 },
+    },
+    {
+        12345U, { 0x01,0x23,0x45,0x67,0x89,0xAB,0xCD,0xEF }, 1000000000000ULL,
+        { 0x71,0x7A,0xB6,0xBF,0xE1,0x8D,0x96,0x79, 0xE3,0xB3,0xFB,0xC6,0x1D,0xE3,0xE5,0x43 },
+    },
+};
+
+#endif
+
+
+static uint64_t next_rand(uint64_t * pstate)
+{
+    return wau8_mix64(*pstate += WAU8_MIX_GAMMA);
+}
+
+
+// compares a result with the reference, records a failure if they differ
+static void compare(
+    wau8_check_result_t * presult,
+    const char * path,
+    const check_case_t * pcase,
+    const uint8_t * pout,
+    const uint64_t end_offset)
+{
+    presult->checks++;
+    presult->bytes += pcase->sz;
+
+    if ((memcmp(pout, pcase->pref, pcase->sz) != 0) ||
+        (end_offset != (pcase->offset + pcase->sz)))
+    {
+        if (presult->failures == 0U)
+        {
+            snprintf(presult->first, sizeof(presult->first),
+                "%s: offset %llu, %lu bytes, src align %u, dst align %u",
+                path,
+                (unsigned long long)pcase->offset,
+                (unsigned long)pcase->sz,
+                (unsigned int)((uintptr_t)pcase->psrc % ALIGN_SPAN),
+                (unsigned int)((uintptr_t)pcase->pdst % ALIGN_SPAN));
+        }
+        presult->failures++;
+    }
+}
+
+
+// records the outcome of a check that isn't a keystream comparison
+static void expect(wau8_check_result_t * presult, const int ok, const char * what)
+{
+    presult->checks++;
+    if (!ok)
+    {
+        if (presult->failures == 0U)
+        {
+            snprintf(presult->first, sizeof(presult->first), "%s", what);
+        }
+        presult->failures++;
+    }
+}
+
+
+// sets up a context at the case's key and offset
+static void start(
+    wau8_context_t * pcontext,
+    const check_case_t * pcase,
+    const int ext,
+    const int fused)
+{
+    wau8_set_wheels(pcontext, &wheels);
+    if (ext)
+    {
+        wau8_set_ext_wheels(pcontext, &xwheels);
+    }
+    if (fused)
+    {
+        wau8_set_fused_wheels(pcontext, &fwheels);
+    }
+    wau8_set_key(pcontext, &pcase->key);
+    wau8_seek(pcontext, pcase->offset);
+}
+
+
+// splits sz into up to MAX_PIECES random lengths, returns the number of pieces
+static size_t split(uint64_t * prng, const size_t sz, size_t * plens)
+{
+    size_t n = 1U + (size_t)(next_rand(prng) % MAX_PIECES);
+    size_t left = sz;
+    size_t ii;
+
+    for (ii = 0; ii < (n - 1U); ii++)
+    {
+        plens[ii] = (left == 0U) ? 0U : (size_t)(next_rand(prng) % (left + 1U));
+        left -= plens[ii];
+    }
+    plens[n - 1U] = left;
+    return n;
+}
+
+
+static void check_get_val(wau8_check_result_t * presult, const check_case_t * pcase)
+{
+    wau8_context_t con;
+    size_t jj;
+
+    start(&con, pcase, 0, 0);
+    for (jj = 0; jj < pcase->sz; jj++)
+    {
+        pcase->pdst[jj] = pcase->psrc[jj] ^ wau8_get_val(&con);
+        wau8_advance(&con);
+    }
+    compare(presult, "get_val", pcase, pcase->pdst, wau8_get_offset(&con));
+}
+
+
+static void check_xor(
+    wau8_check_result_t * presult,
+    const char * path,
+    const check_case_t * pcase,
+    const int ext,
+    const int fused)
+{
+    wau8_context_t con;
+
+    start(&con, pcase, ext, fused);
+    wau8_xor(&con, pcase->psrc, pcase->pdst, pcase->sz);
+    compare(presult, path, pcase, pcase->pdst, wau8_get_offset(&con));
+}
+
+
+// every backend the CPU has, with the scalar or fused loop for the tail
+static void check_backends(wau8_check_result_t * presult, const check_case_t * pcase)
+{
+    char path[64];
+    int bb;
+
+    for (bb = WAU8_BACKEND_SCALAR; bb <= WAU8_BACKEND_AVX512; bb++)
+    {
+        if (wau8_backend_available((wau8_backend_t)bb))
+        {
+            wau8_set_backend((wau8_backend_t)bb);
+            snprintf(path, sizeof(path), "xor ext %s", wau8_backend_name((wau8_backend_t)bb));
+            check_xor(presult, path, pcase, 1, 0);
+            snprintf(path, sizeof(path), "xor ext+fused %s", wau8_backend_name((wau8_backend_t)bb));
+            check_xor(presult, path, pcase, 1, 1);
+        }
+    }
+}
+
+
+// same message in pieces, the keystream has to run on across calls
+static void check_pieces(
+    wau8_check_result_t * presult,
+    const check_case_t * pcase,
+    uint64_t * prng)
+{
+    wau8_context_t con;
+    size_t lens[MAX_PIECES];
+    size_t n = split(prng, pcase->sz, lens);
+    size_t done = 0U;
+    size_t ii;
+
+    start(&con, pcase, 1, 1);
+    for (ii = 0; ii < n; ii++)
+    {
+        wau8_xor(&con, pcase->psrc + done, pcase->pdst + done, lens[ii]);
+        done += lens[ii];
+    }
+    compare(presult, "xor pieces", pcase, pcase->pdst, wau8_get_offset(&con));
+}
+
+
+static void check_inplace(wau8_check_result_t * presult, const check_case_t * pcase)
+{
+    wau8_context_t con;
+
+    memcpy(pcase->pdst, pcase->psrc, pcase->sz);
+    start(&con, pcase, 1, 0);
+    wau8_xor_inplace(&con, pcase->pdst, pcase->sz);
+    compare(presult, "xor_inplace", pcase, pcase->pdst, wau8_get_offset(&con));
+}
+
+
+// source and destination lists split in different places
+static void check_xorv(
+    wau8_check_result_t * presult,
+    const check_case_t * pcase,
+    uint64_t * prng)
+{
+    wau8_context_t con;
+    wau8_iovec_t src_iov[MAX_PIECES];
+    wau8_iovec_t dst_iov[MAX_PIECES];
+    size_t lens[MAX_PIECES];
+    size_t src_count = split(prng, pcase->sz, lens);
+    size_t dst_count;
+    size_t done = 0U;
+    size_t total;
+    size_t ii;
+
+    for (ii = 0; ii < src_count; ii++)
+    {
+        src_iov[ii].pbase = (uint8_t *)pcase->psrc + done;
+        src_iov[ii].sz = lens[ii];
+        done += lens[ii];
+    }
+
+    dst_count = split(prng, pcase->sz, lens);
+    done = 0U;
+    for (ii = 0; ii < dst_count; ii++)
+    {
+        dst_iov[ii].pbase = pcase->pdst + done;
+        dst_iov[ii].sz = lens[ii];
+        done += lens[ii];
+    }
+
+    start(&con, pcase, 1, 0);
+    total = wau8_xorv(&con, src_iov, src_count, dst_iov, dst_count);
+    compare(presult, "xorv", pcase, pcase->pdst,
+        (total == pcase->sz) ? wau8_get_offset(&con) : 0U);
+
+    memcpy(pcase->pdst, pcase->psrc, pcase->sz);
+    start(&con, pcase, 1, 0);
+    total = wau8_xorv_inplace(&con, dst_iov, dst_count);
+    compare(presult, "xorv_inplace", pcase, pcase->pdst,
+        (total == pcase->sz) ? wau8_get_offset(&con) : 0U);
+}
+
+
+// small chunks so even short messages are split between threads
+static void check_par(
+    wau8_check_result_t * presult,
+    const check_case_t * pcase,
+    uint64_t * prng)
+{
+    wau8_context_t con;
+    wau8_par_cfg_t cfg;
+
+    wau8_par_init_cfg(&cfg);
+    cfg.nthreads = 3;
+    cfg.chunk_sz = 1U + (size_t)(next_rand(prng) % 512U);
+
+    start(&con, pcase, 1, 0);
+    wau8_xor_par(&con, pcase->psrc, pcase->pdst, pcase->sz, &cfg);
+    compare(presult, "xor_par", pcase, pcase->pdst, wau8_get_offset(&con));
+}
+
+
+// bitsliced engine, 64 runs of the one buffer
+// (messages under 512 bytes go straight through wau8_xor)
+static void check_bs(wau8_check_result_t * presult, const check_case_t * pcase)
+{
+    wau8_context_t con;
+
+    start(&con, pcase, 0, 0);
+    wau8_xor_bs(&bs, &con, pcase->psrc, pcase->pdst, pcase->sz);
+    compare(presult, "xor_bs", pcase, pcase->pdst, wau8_get_offset(&con));
+}
+
+
+// batch items each start at offset 0 with their own key
+// so each one is compared with its own reference
+static void check_batch(
+    wau8_check_result_t * presult,
+    const check_case_t * pcase,
+    uint64_t * prng,
+    uint8_t * pref)
+{
+    wau8_context_t con;
+    wau8_batch_item_t items[BATCH_ITEMS];
+    size_t lens[BATCH_ITEMS];
+    size_t done = 0U;
+    size_t ii;
+    size_t kk;
+
+    for (ii = 0; ii < BATCH_ITEMS; ii++)
+    {
+        lens[ii] = (size_t)(next_rand(prng) % ((pcase->sz / BATCH_ITEMS) + 1U));
+        for (kk = 0; kk < WAU8_KEY_SZ; kk++)
+        {
+            items[ii].key[kk] = (uint8_t)next_rand(prng);
+        }
+        items[ii].psrc = pcase->psrc + done;
+        items[ii].pdst = pcase->pdst + done;
+        items[ii].sz = lens[ii];
+        done += lens[ii];
+    }
+
+    // no extended wheels so the batch makes its own
+    wau8_set_wheels(&con, &wheels);
+    wau8_xor_batch(&con, items, BATCH_ITEMS);
+
+    for (ii = 0; ii < BATCH_ITEMS; ii++)
+    {
+        check_case_t item;
+        memcpy(item.key, items[ii].key, WAU8_KEY_SZ);
+        item.offset = 0U;
+        item.sz = lens[ii];
+        item.psrc = items[ii].psrc;
+        item.pref = pref;
+        item.pdst = items[ii].pdst;
+        wau8_ref_xor(&wheels, &item.key, 0U, item.psrc, pref, item.sz);
+        compare(presult, "xor_batch", &item, item.pdst, item.sz);
+    }
+}
+
+
+static void make_wheels(const uint64_t seed)
+{
+    wau8_make_wheels(&wheels, seed);
+    wau8_make_ext_wheels(&xwheels, &wheels);
+    wau8_make_fused_wheels(&fwheels, &wheels);
+}
+
+
+#if !defined(WAU8_GEOMETRY)
+
+// known-answer vectors through the reference and through wau8_xor
+static void check_kats(wau8_check_result_t * presult, uint8_t * pzero, uint8_t * pout)
+{
+    size_t ii;
+
+    for (ii = 0; ii < (sizeof(KATS) / sizeof(KATS[0])); ii++)
+    {
+        check_case_t kat;
+        memcpy(kat.key, KATS[ii].key, WAU8_KEY_SZ);
+        kat.offset = KATS[ii].offset;
+        kat.sz = sizeof(KATS[ii].val);
+        kat.psrc = pzero;
+        kat.pref = KATS[ii].val;
+        kat.pdst = pout;
+
+        memset(pzero, 0, kat.sz);
+        make_wheels(KATS[ii].seed);
+        wau8_ref_xor(&wheels, &kat.key, kat.offset, pzero, pout, kat.sz);
+        compare(presult, "known answer (reference)", &kat, pout, kat.offset + kat.sz);
+        check_xor(presult, "known answer (xor)", &kat, 1, 1);
+        presult->cases++;
+    }
+}
+
+#endif
+
+
+void wau8_check_init_cfg(wau8_check_cfg_t * pcfg)
+{
+    pcfg->seed = 1U;
+    pcfg->cases = WAU8_CHECK_CASES;
+    pcfg->max_sz = WAU8_CHECK_MAX_SZ;
+}
+
+
+// wide variant with its own wheels from the case's seed, against its reference:
+// wau8w_xor in pieces, wau8w_keystream, and seek, get_val and advance
+static void check_wide(
+    wau8_check_result_t * presult,
+    const check_case_t * pcase,
+    uint64_t * prng,
+    uint8_t * pwref)
+{
+    check_case_t wc = *pcase;
+    wau8w_context_t con;
+    size_t lens[MAX_PIECES];
+    size_t n = split(prng, pcase->sz, lens);
+    size_t done = 0U;
+    size_t ii;
+    uint64_t step;
+    int ok = 1;
+
+    wau8w_make_wheels(&wwheels, next_rand(prng));
+    wau8w_ref_xor(&wwheels, &pcase->key, pcase->offset, pcase->psrc, pwref, pcase->sz);
+    wc.pref = pwref;
+
+    wau8w_set_wheels(&con, &wwheels);
+    wau8w_set_key(&con, &pcase->key);
+    wau8w_seek(&con, pcase->offset);
+    for (ii = 0; ii < n; ii++)
+    {
+        wau8w_xor(&con, pcase->psrc + done, pcase->pdst + done, lens[ii]);
+        done += lens[ii];
+    }
+    compare(presult, "wide xor pieces", &wc, pcase->pdst, wau8w_get_offset(&con));
+
+    // keystream of the case length is the reference XORed with the source
+    wau8w_seek(&con, pcase->offset);
+    wau8w_keystream(&con, pcase->pdst, pcase->sz);
+    for (ii = 0; ii < pcase->sz; ii++)
+    {
+        pcase->pdst[ii] ^= pcase->psrc[ii];
+    }
+    compare(presult, "wide keystream", &wc, pcase->pdst, wau8w_get_offset(&con));
+
+    // step values from a seek part way through a step
+    wau8w_seek(&con, pcase->offset);
+    step = pcase->offset / 8U;
+    for (ii = 0; ii < 4U; ii++)
+    {
+        ok = ok && (wau8w_get_val(&con) == wau8w_ref_step(&wwheels, &pcase->key, step + ii));
+        wau8w_advance(&con);
+        ok = ok && (wau8w_get_offset(&con) == ((step + ii + 1U) * 8U));
+    }
+    expect(presult, ok, "wide seek/get_val/advance");
+}
+
+
+// registry: dedup, references, stale handles, reuse of released entries,
+// the exact capacity, and threads adding, binding and releasing the same
+// few sets at once
+static void check_reg(wau8_check_result_t * presult, const uint64_t seed)
+{
+    const uint8_t key[WAU8_KEY_SZ] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    wau8_reg_t reg;
+    wau8_reg_handle_t h1;
+    wau8_reg_handle_t h2;
+    wau8_reg_handle_t h3;
+    const wau8_wheels_t * pstored;
+    wau8_context_t con;
+    uint8_t zero[64] = { 0 };
+    uint8_t out[64];
+    uint8_t ref[64];
+    uint32_t ii;
+    int failed = 0;
+
+    for (ii = 0; ii < 4U; ii++)
+    {
+        wau8_make_wheels(&reg_wheels[ii], seed + ii);
+    }
+
+    expect(presult, wau8_reg_init(&reg, 0U) != 0, "reg: 0 sets accepted");
+    expect(presult, wau8_reg_init(&reg, WAU8_REG_MAX_SETS + 1U) != 0, "reg: too many sets accepted");
+    if (wau8_reg_init(&reg, REG_SETS) != 0)
+    {
+        expect(presult, 0, "reg: init failed");
+        return;
+    }
+
+    // the same wheels twice give one set with two references
+    h1 = wau8_reg_add(&reg, &reg_wheels[0]);
+    h2 = wau8_reg_add(&reg, &reg_wheels[0]);
+    expect(presult, (h1 != WAU8_REG_NONE) && (h1 == h2), "reg: add didn't dedup");
+    expect(presult, wau8_reg_count(&reg) == 1U, "reg: count after dedup");
+    expect(presult,
+        (wau8_reg_wheels(&reg, h1) != NULL) &&
+        (memcmp(wau8_reg_wheels(&reg, h1), &reg_wheels[0], sizeof(reg_wheels[0])) == 0),
+        "reg: stored wheels differ");
+
+    // a bound context gives the reference keystream
+    expect(presult, wau8_reg_bind(&reg, h1, &con) == 0, "reg: bind failed");
+    wau8_set_key(&con, &key);
+    wau8_xor(&con, zero, out, sizeof(out));
+    wau8_ref_xor(&reg_wheels[0], &key, 0U, zero, ref, sizeof(ref));
+    expect(presult, memcmp(out, ref, sizeof(out)) == 0, "reg: bound keystream differs");
+
+    // the set lasts until its third reference goes, then its handle is stale
+    expect(presult, wau8_reg_retain(&reg, h1) == 0, "reg: retain failed");
+    wau8_reg_release(&reg, h1);
+    wau8_reg_release(&reg, h1);
+    expect(presult, wau8_reg_wheels(&reg, h1) != NULL, "reg: set gone with a reference left");
+    wau8_reg_release(&reg, h1);
+    expect(presult,
+        (wau8_reg_wheels(&reg, h1) == NULL) && (wau8_reg_retain(&reg, h1) != 0) &&
+        (wau8_reg_bind(&reg, h1, &con) != 0) && (wau8_reg_count(&reg) == 0U),
+        "reg: stale handle accepted");
+
+    // adding the wheels again gives a new handle, the old one stays stale
+    h2 = wau8_reg_add(&reg, &reg_wheels[0]);
+    expect(presult, (h2 != WAU8_REG_NONE) && (h2 != h1), "reg: handle reused");
+    expect(presult, wau8_reg_wheels(&reg, h1) == NULL, "reg: stale handle revived");
+
+    // once released the entry is reused for the next set added, under a
+    // new handle, and the old handle can't reach or release the new set
+    pstored = wau8_reg_wheels(&reg, h2);
+    wau8_reg_release(&reg, h2);
+    h3 = wau8_reg_add(&reg, &reg_wheels[1]);
+    expect(presult,
+        (h3 != WAU8_REG_NONE) && (h3 != h2) && (wau8_reg_wheels(&reg, h3) == pstored),
+        "reg: released entry not reused");
+    wau8_reg_release(&reg, h2);
+    expect(presult,
+        (wau8_reg_wheels(&reg, h2) == NULL) && (wau8_reg_retain(&reg, h2) != 0) &&
+        (wau8_reg_bind(&reg, h2, &con) != 0),
+        "reg: stale handle reached a reused entry");
+    expect(presult,
+        (wau8_reg_wheels(&reg, h3) != NULL) && (wau8_reg_count(&reg) == 1U) &&
+        (memcmp(wau8_reg_wheels(&reg, h3), &reg_wheels[1], sizeof(reg_wheels[1])) == 0),
+        "reg: stale release dropped a reused entry");
+    wau8_reg_release(&reg, h3);
+    expect(presult,
+        (wau8_reg_wheels(&reg, h3) == NULL) && (wau8_reg_count(&reg) == 0U),
+        "reg: reused entry not released");
+
+    // exactly REG_SETS distinct sets fit, and they fit again once released
+    for (ii = 0; (ii < REG_SETS) && !failed; ii++)
+    {
+        wau8_make_wheels(&wheels, seed + 100U + ii);
+        failed = (wau8_reg_add(&reg, &wheels) == WAU8_REG_NONE);
+    }
+    expect(presult, !failed, "reg: full before capacity");
+    wau8_make_wheels(&wheels, seed + 99U);
+    expect(presult, wau8_reg_add(&reg, &wheels) == WAU8_REG_NONE, "reg: more sets than capacity");
+    wau8_reg_free(&reg);
+
+    // threads each take and drop references to the same few sets
+    // and every handle they hold has to keep working
+    if (wau8_reg_init(&reg, 4U) == 0)
+    {
+        int bad = 0;
+        int rr;
+
+#pragma omp parallel for reduction(+:bad) num_threads(4)
+        for (rr = 0; rr < (int)(4U * REG_ROUNDS); rr++)
+        {
+            const wau8_wheels_t * pw = &reg_wheels[(unsigned int)rr % 4U];
+            wau8_reg_handle_t h = wau8_reg_add(&reg, pw);
+            wau8_context_t tcon;
+
+            if ((h == WAU8_REG_NONE) || (wau8_reg_bind(&reg, h, &tcon) != 0) ||
+                (tcon.pwheels == NULL) || (memcmp(tcon.pwheels, pw, sizeof(*pw)) != 0))
+            {
+                bad++;
+            }
+            wau8_reg_release(&reg, h);
+        }
+
+        expect(presult, (bad == 0) && (wau8_reg_count(&reg) == 0U), "reg: threads lost a set");
+        wau8_reg_free(&reg);
+    }
+    else
+    {
+        expect(presult, 0, "reg: init failed");
+    }
+}
+
+
+// runs the known-answer vectors and the random cases
+// returns 0 if everything matched, -1 if not (or out of memory)
+// the selected backend is put back afterwards
+int wau8_check(const wau8_check_cfg_t * pcfg, wau8_check_result_t * presult)
+{
+    wau8_check_cfg_t cfg;
+    wau8_backend_t backend = wau8_get_backend();
+    uint8_t * psrc;
+    uint8_t * pref;
+    uint8_t * pdst;
+    uint8_t * pbatch_ref;
+    uint8_t * pwide_ref;
+    uint64_t rng;
+    unsigned int ii;
+
+    if (pcfg == NULL)
+    {
+        wau8_check_init_cfg(&cfg);
+    }
+    else
+    {
+        cfg = *pcfg;
+    }
+
+    memset(presult, 0, sizeof(*presult));
+    psrc = (uint8_t *)malloc(cfg.max_sz + ALIGN_SPAN);
+    pref = (uint8_t *)malloc(cfg.max_sz + ALIGN_SPAN);
+    pdst = (uint8_t *)malloc(cfg.max_sz + ALIGN_SPAN);
+    pbatch_ref = (uint8_t *)malloc(cfg.max_sz + ALIGN_SPAN);
+    pwide_ref = (uint8_t *)malloc(cfg.max_sz + ALIGN_SPAN);
+    if ((psrc == NULL) || (pref == NULL) || (pdst == NULL) ||
+        (pbatch_ref == NULL) || (pwide_ref == NULL))
+    {
+        free(psrc);
+        free(pref);
+        free(pdst);
+        free(pbatch_ref);
+        free(pwide_ref);
+        snprintf(presult->first, sizeof(presult->first), "out of memory");
+        presult->failures++;
+        return -1;
+    }
+
+#if !defined(WAU8_GEOMETRY)
+    check_kats(presult, psrc, pdst);
+#endif
+    check_reg(presult, cfg.seed);
+
+    rng = cfg.seed;
+    for (ii = 0; ii < cfg.cases; ii++)
+    {
+        check_case_t cc;
+        uint64_t r = next_rand(&rng);
+        size_t src_align = (size_t)(next_rand(&rng) % ALIGN_SPAN);
+        size_t dst_align = (size_t)(next_rand(&rng) % ALIGN_SPAN);
+        size_t jj;
+
+        make_wheels(next_rand(&rng));
+        for (jj = 0; jj < WAU8_KEY_SZ; jj++)
+        {
+            cc.key[jj] = (uint8_t)next_rand(&rng);
+        }
+
+        // mostly short messages, some up to the longest
+        // offsets near the start, anywhere, or just short of 2^63
+        cc.sz = (size_t)(next_rand(&rng) % (((r & 1U) ? cfg.max_sz : 256U) + 1U));
+        switch ((r >> 1U) % 3U)
+        {
+        case 0: cc.offset = next_rand(&rng) % 1024U; break;
+        case 1: cc.offset = next_rand(&rng) & OFFSET_MASK; break;
+        default: cc.offset = OFFSET_MASK - cc.sz - (next_rand(&rng) % 1024U); break;
+        }
+
+        for (jj = 0; jj < cc.sz; jj++)
+        {
+            psrc[src_align + jj] = (uint8_t)next_rand(&rng);
+        }
+        cc.psrc = psrc + src_align;
+        cc.pdst = pdst + dst_align;
+        cc.pref = pref;
+        wau8_ref_xor(&wheels, &cc.key, cc.offset, cc.psrc, pref, cc.sz);
+
+        check_get_val(presult, &cc);
+        check_xor(presult, "xor", &cc, 0, 0);
+        check_xor(presult, "xor fused", &cc, 0, 1);
+        check_backends(presult, &cc);
+        wau8_set_backend(backend);
+        check_pieces(presult, &cc, &rng);
+        check_inplace(presult, &cc);
+        check_xorv(presult, &cc, &rng);
+        check_par(presult, &cc, &rng);
+        check_bs(presult, &cc);
+        check_batch(presult, &cc, &rng, pbatch_ref);
+        check_wide(presult, &cc, &rng, pwide_ref);
+        presult->cases++;
+    }
+
+    wau8_set_backend(backend);
+    free(psrc);
+    free(pref);
+    free(pdst);
+    free(pbatch_ref);
+    free(pwide_ref);
+    return (presult->failures == 0U) ? 0 : -1;
+}
@@ -0,0 +1,77 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#ifndef WAU8_CHECK_H_
+#define WAU8_CHECK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "wau8.h"
+
+// differential check of every way of making keystream against wau8_ref
+//
+// each case picks random wheels, key, offset, length and buffer alignments
+// and runs the byte-at-a-time functions, wau8_xor with plain, fused and
+// extended wheels on every backend the CPU has, wau8_xor in pieces,
+// the in-place and scatter/gather functions, wau8_xor_par and
+// wau8_xor_batch, comparing each with the reference
+// the wide variant (wau8w) is checked against its own reference
+// the wheel registry is checked too: dedup, references, stale handles,
+// capacity and threads sharing sets
+// known-answer vectors for the default geometry are checked first
+// so a change to the reference or to wau8_make_wheels is caught too
+
+#define WAU8_CHECK_CASES        (200U)
+#define WAU8_CHECK_MAX_SZ       (4096U)
+
+typedef struct
+{
+    uint64_t seed;      // seed for the random cases
+    unsigned int cases; // number of random cases
+    size_t max_sz;      // longest message
+} wau8_check_cfg_t;
+
+typedef struct
+{
+    uint64_t cases;     // cases run, including known-answer vectors
+    uint64_t checks;    // comparisons made
+    uint64_t bytes;     // bytes compared
+    uint64_t failures;  // comparisons that didn't match
+    char first[160];    // description of the first failure
+} wau8_check_result_t;
+
+
+void wau8_check_init_cfg(wau8_check_cfg_t * pcfg);
+int wau8_check(const wau8_check_cfg_t * pcfg, wau8_check_result_t * presult);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WAU8_CHECK_H_
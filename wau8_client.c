@@ -0,0 +1,361 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include "wau8_client.h"
+#include "wau8d_proto.h"
+
+
+static int send_all(const int fd, struct iovec * piov, int count, const int passfd)
+{
+    union
+    {
+        struct cmsghdr hdr;
+        char buff[CMSG_SPACE(sizeof(int))];
+    } ctl;
+    struct msghdr msg;
+
+    memset(&msg, 0, sizeof(msg));
+    if (passfd >= 0)
+    {
+        struct cmsghdr * pcmsg;
+        memset(&ctl, 0, sizeof(ctl));
+        msg.msg_control = ctl.buff;
+        msg.msg_controllen = sizeof(ctl.buff);
+        pcmsg = CMSG_FIRSTHDR(&msg);
+        pcmsg->cmsg_level = SOL_SOCKET;
+        pcmsg->cmsg_type = SCM_RIGHTS;
+        pcmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(pcmsg), &passfd, sizeof(int));
+    }
+
+    while (count > 0)
+    {
+        ssize_t n;
+
+        msg.msg_iov = piov;
+        msg.msg_iovlen = (size_t)count;
+        n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+
+        // the fd only goes with the first part
+        msg.msg_control = NULL;
+        msg.msg_controllen = 0;
+        while ((count > 0) && ((size_t)n >= piov->iov_len))
+        {
+            n -= (ssize_t)piov->iov_len;
+            piov++;
+            count--;
+        }
+        if (count > 0)
+        {
+            piov->iov_base = (uint8_t *)piov->iov_base + n;
+            piov->iov_len -= (size_t)n;
+        }
+    }
+    return 0;
+}
+
+
+static int recv_all(const int fd, void * p, size_t len)
+{
+    uint8_t * pb = (uint8_t *)p;
+
+    while (len > 0U)
+    {
+        ssize_t n = recv(fd, pb, len, 0);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0)
+        {
+            errno = ECONNRESET;
+            return -1;
+        }
+        pb += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+
+// sends a request and waits for its reply
+// the request payload comes from psrc and the reply payload goes to pdst
+// so neither is copied on this side
+static int call(
+    wau8_client_t * pclient,
+    wau8d_req_t * preq,
+    const void * psrc,
+    uint8_t * pdst,
+    const int passfd)
+{
+    struct iovec iov[2];
+    wau8d_rep_t rep;
+    int count = 1;
+
+    preq->magic = WAU8D_REQ_MAGIC;
+    preq->reserved = 0U;
+    preq->tag = ++pclient->tag;
+    iov[0].iov_base = preq;
+    iov[0].iov_len = sizeof(*preq);
+    if ((psrc != NULL) && (preq->len > 0U))
+    {
+        iov[1].iov_base = (void *)psrc;
+        iov[1].iov_len = preq->len;
+        count = 2;
+    }
+
+    if ((send_all(pclient->fd, iov, count, passfd) != 0) ||
+        (recv_all(pclient->fd, &rep, sizeof(rep)) != 0))
+    {
+        return -1;
+    }
+    if ((rep.magic != WAU8D_REP_MAGIC) || (rep.tag != preq->tag) ||
+        ((rep.len != 0U) && ((pdst == NULL) || (rep.len != preq->len))))
+    {
+        errno = EPROTO;
+        return -1;
+    }
+    if ((rep.len != 0U) && (recv_all(pclient->fd, pdst, rep.len) != 0))
+    {
+        return -1;
+    }
+
+    pclient->offset = rep.offset;
+    return (int)rep.status;
+}
+
+
+int wau8_client_connect(wau8_client_t * pclient, const char * path)
+{
+    struct sockaddr_un addr;
+
+    memset(pclient, 0, sizeof(*pclient));
+    pclient->fd = -1;
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+
+    pclient->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (pclient->fd < 0)
+    {
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    if (connect(pclient->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        close(pclient->fd);
+        pclient->fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+
+// the daemon frees the connection's streams when it goes
+void wau8_client_disconnect(wau8_client_t * pclient)
+{
+    if (pclient->pshm != NULL)
+    {
+        munmap(pclient->pshm, pclient->shm_sz);
+        pclient->pshm = NULL;
+    }
+    if (pclient->fd >= 0)
+    {
+        close(pclient->fd);
+        pclient->fd = -1;
+    }
+}
+
+
+// starts a stream with a key at a keystream offset
+int wau8_client_open(
+    wau8_client_t * pclient,
+    const uint32_t stream,
+    const wau8_key_t pkey,
+    const uint64_t offset)
+{
+    wau8d_req_t req;
+
+    memset(&req, 0, sizeof(req));
+    req.op = WAU8D_OP_OPEN;
+    req.stream = stream;
+    req.len = WAU8_KEY_SZ;
+    req.offset = offset;
+    return call(pclient, &req, *pkey, NULL, -1);
+}
+
+
+// encrypts/decrypts sz bytes of a stream from offset, or from where
+// the stream left off if offset is WAU8D_OFFSET_NEXT
+// source and destination may be the same buffer
+int wau8_client_xor(
+    wau8_client_t * pclient,
+    const uint32_t stream,
+    const uint64_t offset,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz)
+{
+    wau8d_req_t req;
+    size_t done = 0U;
+    int result = 0;
+
+    memset(&req, 0, sizeof(req));
+    req.op = WAU8D_OP_XOR;
+    req.stream = stream;
+    req.offset = offset;
+
+    do
+    {
+        size_t n = sz - done;
+        req.len = (uint32_t)((n < WAU8D_MAX_PAYLOAD) ? n : WAU8D_MAX_PAYLOAD);
+        result = call(pclient, &req, psrc + done, pdst + done, -1);
+        done += req.len;
+        req.offset = WAU8D_OFFSET_NEXT;
+    } while ((result == 0) && (done < sz));
+
+    return result;
+}
+
+
+// makes a shared buffer of sz bytes (pclient->pshm) and hands it to
+// the daemon, data in it can then be done in place with wau8_client_xor_shm
+int wau8_client_map(wau8_client_t * pclient, const size_t sz)
+{
+    wau8d_req_t req;
+    void * p;
+    int mfd;
+    int result;
+
+    if (sz > UINT32_MAX)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // the daemon only maps a buffer that can't shrink under it
+    mfd = memfd_create("wau8", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (mfd < 0)
+    {
+        return -1;
+    }
+    if ((ftruncate(mfd, (off_t)sz) != 0) ||
+        (fcntl(mfd, F_ADD_SEALS, F_SEAL_SHRINK) != 0))
+    {
+        close(mfd);
+        return -1;
+    }
+    p = mmap(NULL, sz, PROT_READ | PROT_WRITE, MAP_SHARED, mfd, 0);
+    if (p == MAP_FAILED)
+    {
+        close(mfd);
+        return -1;
+    }
+
+    memset(&req, 0, sizeof(req));
+    req.op = WAU8D_OP_MAP;
+    req.len = (uint32_t)sz;
+    result = call(pclient, &req, NULL, NULL, mfd);
+    close(mfd);
+    if (result != 0)
+    {
+        munmap(p, sz);
+        return result;
+    }
+
+    if (pclient->pshm != NULL)
+    {
+        munmap(pclient->pshm, pclient->shm_sz);
+    }
+    pclient->pshm = (uint8_t *)p;
+    pclient->shm_sz = sz;
+    return 0;
+}
+
+
+// encrypts/decrypts sz bytes of the shared buffer at pos in place
+int wau8_client_xor_shm(
+    wau8_client_t * pclient,
+    const uint32_t stream,
+    const uint64_t offset,
+    const size_t pos,
+    const size_t sz)
+{
+    wau8d_req_t req;
+
+    if (sz > UINT32_MAX)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    memset(&req, 0, sizeof(req));
+    req.op = WAU8D_OP_XOR_SHM;
+    req.stream = stream;
+    req.len = (uint32_t)sz;
+    req.offset = offset;
+    req.shm_pos = pos;
+    return call(pclient, &req, NULL, NULL, -1);
+}
+
+
+int wau8_client_close(wau8_client_t * pclient, const uint32_t stream)
+{
+    wau8d_req_t req;
+
+    memset(&req, 0, sizeof(req));
+    req.op = WAU8D_OP_CLOSE;
+    req.stream = stream;
+    return call(pclient, &req, NULL, NULL, -1);
+}
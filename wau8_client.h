@@ -0,0 +1,83 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#ifndef WAU8_CLIENT_H_
+#define WAU8_CLIENT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "wau8.h"
+
+// client for the wau8d service (POSIX, shared buffer needs Linux)
+// every call sends one request and waits for its reply
+// messages longer than WAU8D_MAX_PAYLOAD go as several requests
+// a client is used by one thread at a time, open one per thread
+// functions return 0 or a wau8d_status_t on success or failure of the
+// request, or -1 if the connection failed (errno says why)
+
+typedef struct
+{
+    int fd;
+    uint64_t tag;
+    uint64_t offset;    // stream offset from the last reply
+    uint8_t * pshm;     // shared buffer from wau8_client_map
+    size_t shm_sz;
+} wau8_client_t;
+
+
+int wau8_client_connect(wau8_client_t * pclient, const char * path);
+void wau8_client_disconnect(wau8_client_t * pclient);
+int wau8_client_open(
+    wau8_client_t * pclient,
+    const uint32_t stream,
+    const wau8_key_t pkey,
+    const uint64_t offset);
+int wau8_client_xor(
+    wau8_client_t * pclient,
+    const uint32_t stream,
+    const uint64_t offset,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz);
+int wau8_client_map(wau8_client_t * pclient, const size_t sz);
+int wau8_client_xor_shm(
+    wau8_client_t * pclient,
+    const uint32_t stream,
+    const uint64_t offset,
+    const size_t pos,
+    const size_t sz);
+int wau8_client_close(wau8_client_t * pclient, const uint32_t stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WAU8_CLIENT_H_
@@ -0,0 +1,76 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#ifndef WAU8_GEOM_H_
+#define WAU8_GEOM_H_
+
+// wheel geometry
+//
+// all wheel-specific code is generated from these lists at compile time
+// so changing the number or sizes of the wheels needs no hand-written tables
+// a different geometry can be supplied by building with
+// WAU8_GEOMETRY defined as the name of a header that defines the same macros
+//
+// WAU8_WHEELS(X)         X(name, index, size) for every wheel in key order
+//                        sizes must be relatively prime
+// WAU8_WHEEL_PAIRS(X)    X(pair, name0, size0, name1, size1) for wheels
+//                        fused into one table by wau8_make_fused_wheels
+// WAU8_WHEEL_SINGLES(X)  X(name, index, size) for any wheels not in a pair
+// WAU8_POS_T             type big enough to hold a position on any wheel
+//
+// key bytes are 8 bits so on wheels bigger than 256 only the first
+// 256 positions can be selected by the key
+
+#if defined(WAU8_GEOMETRY)
+#include WAU8_GEOMETRY
+#else
+
+// relatively prime wheel sizes
+// should yield cycle size of 2^63.613300375511121451554498835938
+#define WAU8_WHEELS(X) \
+    X(a, 0, 256U)   /* 256 (2^8) */ \
+    X(b, 1, 253U)   /* 253 (11x23) */ \
+    X(c, 2, 251U)   /* 251 (prime) */ \
+    X(d, 3, 249U)   /* 249 (3x83) */ \
+    X(e, 4, 247U)   /* 247 (13x19) */ \
+    X(f, 5, 245U)   /* 245 (5x7x7) */ \
+    X(g, 6, 241U)   /* 241 (prime) */ \
+    X(h, 7, 239U)   /* 239 (prime) */
+
+#define WAU8_WHEEL_PAIRS(X) \
+    X(ab, a, 256U, b, 253U) \
+    X(cd, c, 251U, d, 249U) \
+    X(ef, e, 247U, f, 245U) \
+    X(gh, g, 241U, h, 239U)
+
+#define WAU8_WHEEL_SINGLES(X)
+
+#define WAU8_POS_T              uint8_t
+
+#endif
+
+#endif // WAU8_GEOM_H_
@@ -0,0 +1,132 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#include <string.h>
+#include "wau8_par.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+// fills in the actual thread count and chunk size for a run
+static void get_cfg(
+    const wau8_par_cfg_t * pcfg,
+    int * pnthreads,
+    size_t * pchunk_sz)
+{
+    *pnthreads = 1;
+    *pchunk_sz = WAU8_PAR_CHUNK_SZ;
+
+#ifdef _OPENMP
+    *pnthreads = omp_get_max_threads();
+#endif
+
+    if (pcfg != NULL)
+    {
+        if (pcfg->nthreads > 0)
+        {
+            *pnthreads = pcfg->nthreads;
+        }
+        if (pcfg->chunk_sz > 0U)
+        {
+            *pchunk_sz = pcfg->chunk_sz;
+        }
+    }
+}
+
+
+void wau8_par_init_cfg(wau8_par_cfg_t * pcfg)
+{
+    pcfg->nthreads = 0;
+    pcfg->chunk_sz = WAU8_PAR_CHUNK_SZ;
+}
+
+
+// zeroes a buffer using the same chunk-to-thread assignment as wau8_xor_par
+// on NUMA systems the first write to a page places it near the writing thread
+// so touching a fresh buffer this way keeps each worker on local memory
+void wau8_par_touch(uint8_t * pbuff, const size_t sz, const wau8_par_cfg_t * pcfg)
+{
+    int nthreads;
+    size_t chunk_sz;
+    ptrdiff_t nchunks;
+    ptrdiff_t ii;
+
+    get_cfg(pcfg, &nthreads, &chunk_sz);
+    nchunks = (ptrdiff_t)((sz + chunk_sz - 1U) / chunk_sz);
+
+#pragma omp parallel for schedule(static) num_threads(nthreads)
+    for (ii = 0; ii < nchunks; ii++)
+    {
+        size_t start = (size_t)ii * chunk_sz;
+        size_t len = ((sz - start) < chunk_sz) ? (sz - start) : chunk_sz;
+        memset(pbuff + start, 0, len);
+    }
+}
+
+
+// encrypts/decrypts a buffer by splitting it into chunks that are
+// handed out to worker threads, each chunk gets its own copy of the context
+// moved to the chunk's offset so the result matches wau8_xor exactly
+// static scheduling gives each thread one contiguous run of chunks
+// and the same run every call with the same buffer size and config
+void wau8_xor_par(
+    wau8_context_t * pcontext,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz,
+    const wau8_par_cfg_t * pcfg)
+{
+    const uint64_t base = pcontext->offset;
+    int nthreads;
+    size_t chunk_sz;
+    ptrdiff_t nchunks;
+    ptrdiff_t ii;
+
+    get_cfg(pcfg, &nthreads, &chunk_sz);
+    nchunks = (ptrdiff_t)((sz + chunk_sz - 1U) / chunk_sz);
+
+    // not worth starting threads for a single chunk
+    if ((nthreads < 2) || (nchunks < 2))
+    {
+        wau8_xor(pcontext, psrc, pdst, sz);
+        return;
+    }
+
+#pragma omp parallel for schedule(static) num_threads(nthreads)
+    for (ii = 0; ii < nchunks; ii++)
+    {
+        wau8_context_t con = *pcontext;
+        size_t start = (size_t)ii * chunk_sz;
+        size_t len = ((sz - start) < chunk_sz) ? (sz - start) : chunk_sz;
+        wau8_seek(&con, base + start);
+        wau8_xor(&con, psrc + start, pdst + start, len);
+    }
+
+    wau8_seek(pcontext, base + sz);
+}
@@ -0,0 +1,60 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#ifndef WAU8_PAR_H_
+#define WAU8_PAR_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "wau8.h"
+
+// default number of bytes each worker handles at a time
+#define WAU8_PAR_CHUNK_SZ       (1U << 20U)
+
+typedef struct
+{
+    int nthreads;       // number of worker threads, 0 uses the OpenMP default
+    size_t chunk_sz;    // bytes per chunk, 0 uses WAU8_PAR_CHUNK_SZ
+} wau8_par_cfg_t;
+
+
+void wau8_par_init_cfg(wau8_par_cfg_t * pcfg);
+void wau8_par_touch(uint8_t * pbuff, const size_t sz, const wau8_par_cfg_t * pcfg);
+void wau8_xor_par(
+    wau8_context_t * pcontext,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz,
+    const wau8_par_cfg_t * pcfg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WAU8_PAR_H_
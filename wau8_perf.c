@@ -0,0 +1,218 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#include <string.h>
+#include "wau8_perf.h"
+#include "wau8_simd.h"
+
+#if defined(WAU8_PERF)
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+
+// global counters shared by all contexts and threads
+static wau8_perf_t global_perf;
+
+
+// reads the cycle counter
+// where there isn't one, nanoseconds stand in for cycles
+static uint64_t read_cycles(void)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+
+// relaxed atomics for the global counters
+// (exact totals are needed, ordering with other memory isn't)
+static uint64_t atomic_add(uint64_t * pval, const uint64_t n)
+{
+#if defined(_MSC_VER)
+    return (uint64_t)_InterlockedExchangeAdd64((volatile __int64 *)pval, (__int64)n);
+#else
+    return __atomic_fetch_add(pval, n, __ATOMIC_RELAXED);
+#endif
+}
+
+static uint64_t atomic_load(uint64_t * pval)
+{
+#if defined(_MSC_VER)
+    return (uint64_t)_InterlockedCompareExchange64((volatile __int64 *)pval, 0, 0);
+#else
+    return __atomic_load_n(pval, __ATOMIC_RELAXED);
+#endif
+}
+
+static void atomic_clear(uint64_t * pval)
+{
+#if defined(_MSC_VER)
+    _InterlockedExchange64((volatile __int64 *)pval, 0);
+#else
+    __atomic_store_n(pval, 0U, __ATOMIC_RELAXED);
+#endif
+}
+
+
+// histogram bucket for a timed call
+// quarter cycles per byte so bucket k holds [2^(k-2), 2^(k-1)) cycles per byte
+static unsigned int get_bucket(const uint64_t cycles, const size_t sz)
+{
+    uint64_t q = (cycles * 4U) / sz;
+    unsigned int bucket = 0U;
+
+    while ((q >= 2U) && (bucket < (WAU8_PERF_BUCKETS - 1U)))
+    {
+        q >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+
+// counts a call, returns its start time if it is to be timed or 0 if not
+uint64_t wau8_perf_begin(void)
+{
+    uint64_t n = atomic_add(&global_perf.calls, 1U);
+    return ((n % WAU8_PERF_SAMPLE) == 0U) ? read_cycles() : 0U;
+}
+
+
+// counts the bytes of a call, vec_sz of them done by the vector kernel
+// and the rest by the scalar or fused loop
+void wau8_perf_end(const uint64_t start, const size_t vec_sz, const size_t sz)
+{
+    size_t split[WAU8_PERF_BACKENDS];
+    unsigned int ii;
+
+    // the wider kernels hand their tails to the narrower ones
+    wau8_vec_split(
+        (vec_sz > 0U) ? wau8_get_backend() : WAU8_BACKEND_SCALAR,
+        vec_sz, split);
+    split[WAU8_BACKEND_SCALAR] += sz - vec_sz;
+
+    atomic_add(&global_perf.bytes, sz);
+    for (ii = WAU8_BACKEND_SCALAR; ii < WAU8_PERF_BACKENDS; ii++)
+    {
+        if (split[ii] != 0U)
+        {
+            atomic_add(&global_perf.backend_bytes[ii], split[ii]);
+        }
+    }
+
+    if ((start != 0U) && (sz > 0U))
+    {
+        uint64_t cycles = read_cycles() - start;
+        unsigned int bucket = get_bucket(cycles, sz);
+
+        atomic_add(&global_perf.samples, 1U);
+        atomic_add(&global_perf.sample_bytes, sz);
+        atomic_add(&global_perf.sample_cycles, cycles);
+        atomic_add(&global_perf.hist[bucket], 1U);
+    }
+}
+
+#endif
+
+
+// returns non-zero if the library was built with the counters
+int wau8_perf_enabled(void)
+{
+#if defined(WAU8_PERF)
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+
+// copies out the global counters
+// counters are read one at a time so a copy taken while other threads
+// are running may be a little out of step with itself
+void wau8_perf_get_global(wau8_perf_t * pperf)
+{
+#if defined(WAU8_PERF)
+    uint64_t * psrc = (uint64_t *)&global_perf;
+    uint64_t * pdst = (uint64_t *)pperf;
+    size_t ii;
+
+    for (ii = 0; ii < (sizeof(wau8_perf_t) / sizeof(uint64_t)); ii++)
+    {
+        pdst[ii] = atomic_load(&psrc[ii]);
+    }
+#else
+    memset(pperf, 0, sizeof(*pperf));
+#endif
+}
+
+
+void wau8_perf_reset_global(void)
+{
+#if defined(WAU8_PERF)
+    uint64_t * pval = (uint64_t *)&global_perf;
+    size_t ii;
+
+    for (ii = 0; ii < (sizeof(wau8_perf_t) / sizeof(uint64_t)); ii++)
+    {
+        atomic_clear(&pval[ii]);
+    }
+#endif
+}
+
+
+// average cycles per byte over the timed calls, 0 if there were none
+double wau8_perf_cycles_per_byte(const wau8_perf_t * pperf)
+{
+    if (pperf->sample_bytes == 0U)
+    {
+        return 0.0;
+    }
+    return (double)pperf->sample_cycles / (double)pperf->sample_bytes;
+}
+
+
+// lowest cycles per byte counted in a histogram bucket
+double wau8_perf_bucket_floor(const unsigned int bucket)
+{
+    if (bucket == 0U)
+    {
+        return 0.0;
+    }
+    return (double)(1ULL << bucket) / 4.0;
+}
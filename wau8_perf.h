@@ -0,0 +1,94 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#ifndef WAU8_PERF_H_
+#define WAU8_PERF_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "wau8.h"
+
+// optional instrumentation of the bulk functions
+//
+// when the library is built with WAU8_PERF defined, every call to
+// wau8_xor (and so everything built on it, on any thread) counts its
+// bytes and calls in one global set of counters, along with how many
+// bytes went through each backend, and every WAU8_PERF_SAMPLE-th call
+// is timed with the cycle counter
+// without WAU8_PERF none of this is compiled in and the query functions
+// just return zeroes, so callers don't need to check
+// the counters live here rather than in wau8_context_t so contexts are
+// the same size and layout either way
+//
+// wau8_get_val and wau8_advance are never instrumented
+
+#ifndef WAU8_PERF_SAMPLE
+#define WAU8_PERF_SAMPLE        (64U)
+#endif
+
+// run-time counters for the bulk functions
+// samples are timed calls, hist counts them by cycles per byte:
+// bucket 0 is under 0.5, bucket k is 2^(k-2) up to 2^(k-1),
+// and the last bucket takes everything above that
+#define WAU8_PERF_BACKENDS      (WAU8_BACKEND_AVX512 + 1)
+#define WAU8_PERF_BUCKETS       (16U)
+
+typedef struct
+{
+    uint64_t calls;
+    uint64_t bytes;
+    uint64_t backend_bytes[WAU8_PERF_BACKENDS];
+    uint64_t samples;
+    uint64_t sample_bytes;
+    uint64_t sample_cycles;
+    uint64_t hist[WAU8_PERF_BUCKETS];
+} wau8_perf_t;
+
+int wau8_perf_enabled(void);
+void wau8_perf_get_global(wau8_perf_t * pperf);
+void wau8_perf_reset_global(void);
+double wau8_perf_cycles_per_byte(const wau8_perf_t * pperf);
+double wau8_perf_bucket_floor(const unsigned int bucket);
+
+// hooks used by wau8_xor
+#if defined(WAU8_PERF)
+uint64_t wau8_perf_begin(void);
+void wau8_perf_end(const uint64_t start, const size_t vec_sz, const size_t sz);
+#define WAU8_PERF_BEGIN()           const uint64_t perf_start = wau8_perf_begin();
+#define WAU8_PERF_END(vec_sz, sz)   wau8_perf_end(perf_start, vec_sz, sz);
+#else
+#define WAU8_PERF_BEGIN()
+#define WAU8_PERF_END(vec_sz, sz)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WAU8_PERF_H_
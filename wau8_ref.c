@@ -0,0 +1,116 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#include "wau8_ref.h"
+
+
+// wheel i is at (key[i] + t) mod size[i] at keystream offset t
+// and the keystream byte is the XOR of the values of all wheels there
+// every byte is worked out on its own with nothing carried over
+// from the byte before, so the only things shared with the fast paths
+// are the wheel tables and sizes
+#define GEN_REF_WHEEL(nm, ix, sz)   pwheels->nm,
+
+uint8_t wau8_ref_val(
+    const wau8_wheels_t * pwheels,
+    const wau8_key_t pkey,
+    const uint64_t offset)
+{
+    const uint8_t * pwheel[WAU8_KEY_SZ] = { WAU8_WHEELS(GEN_REF_WHEEL) };
+    uint8_t result = 0U;
+    unsigned int ii;
+
+    for (ii = 0; ii < WAU8_KEY_SZ; ii++)
+    {
+        uint64_t sz = WAU8_WHEEL_SZ[ii];
+        uint64_t pos = (((*pkey)[ii] % sz) + (offset % sz)) % sz;
+        result ^= pwheel[ii][pos];
+    }
+
+    return result;
+}
+
+
+// encrypts/decrypts sz bytes starting at keystream offset
+void wau8_ref_xor(
+    const wau8_wheels_t * pwheels,
+    const wau8_key_t pkey,
+    const uint64_t offset,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz)
+{
+    size_t jj;
+
+    for (jj = 0; jj < sz; jj++)
+    {
+        pdst[jj] = psrc[jj] ^ wau8_ref_val(pwheels, pkey, offset + jj);
+    }
+}
+
+
+// wide variant, the same positions but a 64-bit value per step
+// and keystream byte offset is byte offset % 8 of step offset / 8
+#define GEN_REF_WHEEL_W(nm, ix, sz) pwheels->nm,
+
+uint64_t wau8w_ref_step(
+    const wau8w_wheels_t * pwheels,
+    const wau8_key_t pkey,
+    const uint64_t step)
+{
+    const uint64_t * pwheel[WAU8_KEY_SZ] = { WAU8_WHEELS(GEN_REF_WHEEL_W) };
+    uint64_t result = 0U;
+    unsigned int ii;
+
+    for (ii = 0; ii < WAU8_KEY_SZ; ii++)
+    {
+        uint64_t sz = WAU8_WHEEL_SZ[ii];
+        uint64_t pos = (((*pkey)[ii] % sz) + (step % sz)) % sz;
+        result ^= pwheel[ii][pos];
+    }
+
+    return result;
+}
+
+
+// encrypts/decrypts sz bytes of the wide keystream starting at offset
+void wau8w_ref_xor(
+    const wau8w_wheels_t * pwheels,
+    const wau8_key_t pkey,
+    const uint64_t offset,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz)
+{
+    size_t jj;
+
+    for (jj = 0; jj < sz; jj++)
+    {
+        uint64_t val = wau8w_ref_step(pwheels, pkey, (offset + jj) / 8U);
+        pdst[jj] = psrc[jj] ^ (uint8_t)(val >> (8U * ((offset + jj) % 8U)));
+    }
+}
@@ -0,0 +1,69 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#ifndef WAU8_REF_H_
+#define WAU8_REF_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "wau8.h"
+#include "wau8w.h"
+
+// reference keystream computed straight from the definition of the cipher
+// for checking the fast paths, not for use (tens of times slower)
+
+uint8_t wau8_ref_val(
+    const wau8_wheels_t * pwheels,
+    const wau8_key_t pkey,
+    const uint64_t offset);
+void wau8_ref_xor(
+    const wau8_wheels_t * pwheels,
+    const wau8_key_t pkey,
+    const uint64_t offset,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz);
+
+uint64_t wau8w_ref_step(
+    const wau8w_wheels_t * pwheels,
+    const wau8_key_t pkey,
+    const uint64_t step);
+void wau8w_ref_xor(
+    const wau8w_wheels_t * pwheels,
+    const wau8_key_t pkey,
+    const uint64_t offset,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WAU8_REF_H_
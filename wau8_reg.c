@@ -0,0 +1,407 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#include <stdlib.h>
+#include <string.h>
+#include "wau8_reg.h"
+#include "wau8_session.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#define NO_ENTRY        (0xFFFFFFFFU)
+#define CHUNK_SHIFT     (8U)
+#define REFS_MASK       (0xFFFFFFFFULL)
+
+#define GEN_OF(state)   ((uint32_t)((state) >> 32U))
+#define REFS_OF(state)  ((uint32_t)((state) & REFS_MASK))
+
+
+// atomics for the entry states and the lock
+#if defined(_MSC_VER)
+static uint64_t load_acquire(const volatile uint64_t * p)
+{
+    return (uint64_t)_InterlockedCompareExchange64((volatile __int64 *)p, 0, 0);
+}
+
+static int cas(volatile uint64_t * p, const uint64_t old, const uint64_t val)
+{
+    return (uint64_t)_InterlockedCompareExchange64(
+        (volatile __int64 *)p, (__int64)val, (__int64)old) == old;
+}
+
+static void store_release(volatile uint64_t * p, const uint64_t val)
+{
+    _InterlockedExchange64((volatile __int64 *)p, (__int64)val);
+}
+
+static uint32_t load_acquire32(const volatile uint32_t * p)
+{
+    return (uint32_t)_InterlockedCompareExchange((volatile long *)p, 0, 0);
+}
+
+static void store_release32(volatile uint32_t * p, const uint32_t val)
+{
+    _InterlockedExchange((volatile long *)p, (long)val);
+}
+#else
+static uint64_t load_acquire(const volatile uint64_t * p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static int cas(volatile uint64_t * p, const uint64_t old, const uint64_t val)
+{
+    uint64_t expected = old;
+    return __atomic_compare_exchange_n(
+        p, &expected, val, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static void store_release(volatile uint64_t * p, const uint64_t val)
+{
+    __atomic_store_n(p, val, __ATOMIC_RELEASE);
+}
+
+static uint32_t load_acquire32(const volatile uint32_t * p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static void store_release32(volatile uint32_t * p, const uint32_t val)
+{
+    __atomic_store_n(p, val, __ATOMIC_RELEASE);
+}
+#endif
+
+
+// adding and retiring sets are rare so a spinlock is enough
+static void lock(wau8_reg_t * preg)
+{
+    while (!cas(&preg->lock, 0U, 1U))
+    {
+    }
+}
+
+static void unlock(wau8_reg_t * preg)
+{
+    store_release(&preg->lock, 0U);
+}
+
+
+static wau8_reg_entry_t * entry_at(const wau8_reg_t * preg, const uint32_t ix)
+{
+    return (wau8_reg_entry_t *)(preg->pchunks[ix >> CHUNK_SHIFT] +
+        ((ix & (WAU8_REG_CHUNK - 1U)) * preg->stride));
+}
+
+
+// entry a handle refers to, NULL if the handle is stale or invalid
+// (used is published after the chunk it reaches into)
+static wau8_reg_entry_t * resolve(const wau8_reg_t * preg, const wau8_reg_handle_t handle)
+{
+    const uint32_t ix = (uint32_t)(handle & REFS_MASK);
+    wau8_reg_entry_t * pe;
+
+    if ((handle == WAU8_REG_NONE) || (ix >= load_acquire32(&preg->used)))
+    {
+        return NULL;
+    }
+    pe = entry_at(preg, ix);
+    return (GEN_OF(load_acquire(&pe->state)) == (uint32_t)(handle >> 32U)) ? pe : NULL;
+}
+
+
+static uint32_t bucket_of(const wau8_reg_t * preg, const uint64_t id)
+{
+    return (uint32_t)(id >> 32U) & preg->bucket_mask;
+}
+
+
+// sets up an empty registry for up to max_sets wheel sets
+// (1 to WAU8_REG_MAX_SETS)
+// only the table of chunks is allocated now, chunks come as needed
+// returns 0 or -1 if max_sets is out of range or out of memory
+int wau8_reg_init(wau8_reg_t * preg, const uint32_t max_sets)
+{
+    uint32_t nbuckets = 1U;
+    uint32_t ii;
+
+    memset(preg, 0, sizeof(*preg));
+    if ((max_sets == 0U) || (max_sets > WAU8_REG_MAX_SETS))
+    {
+        return -1;
+    }
+    preg->max_sets = max_sets;
+    preg->max_chunks = (max_sets + WAU8_REG_CHUNK - 1U) / WAU8_REG_CHUNK;
+    preg->stride = ((sizeof(wau8_reg_entry_t) + WAU8_REG_LINE - 1U) / WAU8_REG_LINE) * WAU8_REG_LINE;
+    preg->free_head = NO_ENTRY;
+
+    while (nbuckets < max_sets)
+    {
+        nbuckets <<= 1U;
+    }
+    preg->bucket_mask = nbuckets - 1U;
+
+    preg->pchunks = (uint8_t **)calloc(preg->max_chunks + 1U, sizeof(uint8_t *));
+    preg->praw = (void **)calloc(preg->max_chunks + 1U, sizeof(void *));
+    preg->pbuckets = (uint32_t *)malloc(nbuckets * sizeof(uint32_t));
+    if ((preg->pchunks == NULL) || (preg->praw == NULL) || (preg->pbuckets == NULL))
+    {
+        wau8_reg_free(preg);
+        return -1;
+    }
+
+    for (ii = 0; ii < nbuckets; ii++)
+    {
+        preg->pbuckets[ii] = NO_ENTRY;
+    }
+    return 0;
+}
+
+
+// frees the registry and every set in it
+void wau8_reg_free(wau8_reg_t * preg)
+{
+    uint32_t ii;
+
+    if (preg->praw != NULL)
+    {
+        for (ii = 0; ii < preg->nchunks; ii++)
+        {
+            free(preg->praw[ii]);
+        }
+    }
+    free(preg->pchunks);
+    free(preg->praw);
+    free(preg->pbuckets);
+    memset(preg, 0, sizeof(*preg));
+}
+
+
+// takes an entry from the free list or the arena, NO_ENTRY if full
+static uint32_t take_entry(wau8_reg_t * preg)
+{
+    uint32_t ix = preg->free_head;
+
+    if (ix != NO_ENTRY)
+    {
+        preg->free_head = entry_at(preg, ix)->next;
+        return ix;
+    }
+
+    if (preg->used == preg->max_sets)
+    {
+        return NO_ENTRY;
+    }
+
+    if ((preg->used & (WAU8_REG_CHUNK - 1U)) == 0U)
+    {
+        void * praw;
+
+        praw = calloc(1U, (WAU8_REG_CHUNK * preg->stride) + WAU8_REG_LINE);
+        if (praw == NULL)
+        {
+            return NO_ENTRY;
+        }
+        preg->praw[preg->nchunks] = praw;
+        preg->pchunks[preg->nchunks] = (uint8_t *)praw +
+            (WAU8_REG_LINE - ((uintptr_t)praw % WAU8_REG_LINE));
+        preg->nchunks++;
+    }
+
+    ix = preg->used;
+    store_release32(&preg->used, ix + 1U);
+    return ix;
+}
+
+
+// returns a handle to a stored copy of the wheels, adding them if
+// no identical set is stored yet, with one reference for the caller
+// returns WAU8_REG_NONE if the registry is full or out of memory
+wau8_reg_handle_t wau8_reg_add(wau8_reg_t * preg, const wau8_wheels_t * pwheels)
+{
+    const uint64_t id = wau8_wheels_id(pwheels);
+    const uint32_t bucket = bucket_of(preg, id);
+    wau8_reg_handle_t handle = WAU8_REG_NONE;
+    wau8_reg_entry_t * pe;
+    uint32_t ix;
+
+    lock(preg);
+
+    for (ix = preg->pbuckets[bucket]; ix != NO_ENTRY; ix = pe->next)
+    {
+        pe = entry_at(preg, ix);
+        if ((pe->id == id) && (memcmp(&pe->wheels, pwheels, sizeof(*pwheels)) == 0))
+        {
+            // references only change outside the lock by CAS
+            // and an entry in the hash isn't retired while the lock is held
+            // (one whose last reference has just gone is taken back)
+            uint64_t state;
+            do
+            {
+                state = load_acquire(&pe->state);
+            } while (!cas(&pe->state, state, state + 1U));
+
+            handle = (state & ~REFS_MASK) | ix;
+            unlock(preg);
+            return handle;
+        }
+    }
+
+    ix = take_entry(preg);
+    if (ix != NO_ENTRY)
+    {
+        uint32_t gen;
+
+        pe = entry_at(preg, ix);
+        gen = GEN_OF(pe->state);
+        gen = (gen == 0U) ? 1U : gen;
+        memcpy(&pe->wheels, pwheels, sizeof(*pwheels));
+        wau8_make_ext_wheels(&pe->xwheels, &pe->wheels);
+        pe->id = id;
+        pe->next = preg->pbuckets[bucket];
+        preg->pbuckets[bucket] = ix;
+        store_release32(&preg->live, preg->live + 1U);
+        store_release(&pe->state, ((uint64_t)gen << 32U) | 1U);
+        handle = ((uint64_t)gen << 32U) | ix;
+    }
+
+    unlock(preg);
+    return handle;
+}
+
+
+// adds a reference for another user of a set the caller already holds
+// returns 0 or -1 if the handle is stale
+int wau8_reg_retain(wau8_reg_t * preg, const wau8_reg_handle_t handle)
+{
+    wau8_reg_entry_t * pe = resolve(preg, handle);
+    uint64_t state;
+
+    if (pe == NULL)
+    {
+        return -1;
+    }
+
+    do
+    {
+        state = load_acquire(&pe->state);
+        if ((GEN_OF(state) != (uint32_t)(handle >> 32U)) || (REFS_OF(state) == 0U))
+        {
+            return -1;
+        }
+    } while (!cas(&pe->state, state, state + 1U));
+
+    return 0;
+}
+
+
+// drops a reference, the set is removed when the last one goes
+// and its handles stop working
+void wau8_reg_release(wau8_reg_t * preg, const wau8_reg_handle_t handle)
+{
+    wau8_reg_entry_t * pe = resolve(preg, handle);
+    uint64_t state;
+    uint32_t * plink;
+    uint32_t gen;
+    uint32_t ix;
+
+    if (pe == NULL)
+    {
+        return;
+    }
+
+    do
+    {
+        state = load_acquire(&pe->state);
+        if ((GEN_OF(state) != (uint32_t)(handle >> 32U)) || (REFS_OF(state) == 0U))
+        {
+            return;
+        }
+    } while (!cas(&pe->state, state, state - 1U));
+
+    if (REFS_OF(state) != 1U)
+    {
+        return;
+    }
+
+    // last reference, retire the entry unless wau8_reg_add found it again
+    // in the meantime (moving to the next generation fails if it did)
+    // (generation 0 only marks entries never used, so it is skipped)
+    lock(preg);
+    gen = GEN_OF(state) + 1U;
+    gen = (gen == 0U) ? 1U : gen;
+    if (cas(&pe->state, state & ~REFS_MASK, (uint64_t)gen << 32U))
+    {
+        ix = (uint32_t)(handle & REFS_MASK);
+        plink = &preg->pbuckets[bucket_of(preg, pe->id)];
+        while (*plink != ix)
+        {
+            plink = &entry_at(preg, *plink)->next;
+        }
+        *plink = pe->next;
+        pe->next = preg->free_head;
+        preg->free_head = ix;
+        store_release32(&preg->live, preg->live - 1U);
+    }
+    unlock(preg);
+}
+
+
+// wheels a handle refers to, NULL if the handle is stale
+const wau8_wheels_t * wau8_reg_wheels(const wau8_reg_t * preg, const wau8_reg_handle_t handle)
+{
+    const wau8_reg_entry_t * pe = resolve(preg, handle);
+    return (pe != NULL) ? &pe->wheels : NULL;
+}
+
+
+// sets a context's wheels and extended wheels to a registered set
+// returns 0 or -1 if the handle is stale (the context is left alone)
+int wau8_reg_bind(
+    const wau8_reg_t * preg,
+    const wau8_reg_handle_t handle,
+    wau8_context_t * pcontext)
+{
+    const wau8_reg_entry_t * pe = resolve(preg, handle);
+
+    if (pe == NULL)
+    {
+        return -1;
+    }
+    wau8_set_wheels(pcontext, &pe->wheels);
+    wau8_set_ext_wheels(pcontext, &pe->xwheels);
+    return 0;
+}
+
+
+// number of distinct sets with references
+uint32_t wau8_reg_count(const wau8_reg_t * preg)
+{
+    return load_acquire32(&preg->live);
+}
@@ -0,0 +1,104 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#ifndef WAU8_REG_H_
+#define WAU8_REG_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "wau8.h"
+
+// registry of shared wheel sets
+//
+// many users of the same wheels can share one copy instead of each
+// keeping their own: wau8_reg_add stores a set (with its extended
+// wheels) only if an identical one isn't already there, and returns
+// a handle to it with a reference counted against it
+// sets live in arena chunks of WAU8_REG_CHUNK entries, each entry
+// starting on a cache line, and never move once added
+// a handle holds an entry number and the entry's generation, which
+// changes when the last reference is released, so a stale handle is
+// turned away rather than reaching someone else's wheels
+// wau8_reg_bind, wau8_reg_wheels, wau8_reg_retain and wau8_reg_release
+// take no locks, wau8_reg_add takes a spinlock
+// contexts bound to a set keep pointers into the arena, so a set must
+// not be released while any context still uses it
+
+#define WAU8_REG_CHUNK          (256U)
+#define WAU8_REG_LINE           (64U)
+#define WAU8_REG_NONE           (0U)
+
+// most sets a registry can be made for
+#define WAU8_REG_MAX_SETS       (1U << 24U)
+
+typedef uint64_t wau8_reg_handle_t;
+
+typedef struct
+{
+    wau8_wheels_t wheels;
+    wau8_ext_wheels_t xwheels;
+    volatile uint64_t state;    // generation (high 32 bits) and references
+    uint64_t id;                // wau8_wheels_id
+    uint32_t next;              // hash chain when in use, free list when not
+} wau8_reg_entry_t;
+
+typedef struct
+{
+    uint8_t ** pchunks;         // cache line aligned arena chunks
+    void ** praw;               // the same chunks as allocated
+    uint32_t nchunks;
+    uint32_t max_chunks;
+    uint32_t max_sets;
+    size_t stride;              // entry size rounded up to whole cache lines
+    uint32_t * pbuckets;
+    uint32_t bucket_mask;
+    volatile uint32_t used;     // entries handed out of the arena so far
+    uint32_t free_head;
+    volatile uint32_t live;     // sets with references
+    volatile uint64_t lock;
+} wau8_reg_t;
+
+
+int wau8_reg_init(wau8_reg_t * preg, const uint32_t max_sets);
+void wau8_reg_free(wau8_reg_t * preg);
+wau8_reg_handle_t wau8_reg_add(wau8_reg_t * preg, const wau8_wheels_t * pwheels);
+int wau8_reg_retain(wau8_reg_t * preg, const wau8_reg_handle_t handle);
+void wau8_reg_release(wau8_reg_t * preg, const wau8_reg_handle_t handle);
+const wau8_wheels_t * wau8_reg_wheels(const wau8_reg_t * preg, const wau8_reg_handle_t handle);
+int wau8_reg_bind(
+    const wau8_reg_t * preg,
+    const wau8_reg_handle_t handle,
+    wau8_context_t * pcontext);
+uint32_t wau8_reg_count(const wau8_reg_t * preg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WAU8_REG_H_
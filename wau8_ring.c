@@ -0,0 +1,256 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#include <string.h>
+#include "wau8_ring.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+// loads and stores of the shared counters
+// the consumer must see the keystream bytes before it sees head move
+// and the producer must be done reading tail before it reuses the space
+#if defined(_MSC_VER) && defined(_M_X64)
+// aligned 64-bit accesses are atomic and x64 keeps stores in order
+// so only the compiler needs to be kept from reordering
+static uint64_t load_acquire(const volatile uint64_t * p)
+{
+    uint64_t val = *p;
+    _ReadWriteBarrier();
+    return val;
+}
+
+static void store_release(volatile uint64_t * p, const uint64_t val)
+{
+    _ReadWriteBarrier();
+    *p = val;
+}
+#elif defined(_MSC_VER)
+static uint64_t load_acquire(const volatile uint64_t * p)
+{
+    return (uint64_t)_InterlockedCompareExchange64((volatile __int64 *)p, 0, 0);
+}
+
+static void store_release(volatile uint64_t * p, const uint64_t val)
+{
+    __int64 old = *p;
+    __int64 prev;
+    while ((prev = _InterlockedCompareExchange64((volatile __int64 *)p, (__int64)val, old)) != old)
+    {
+        old = prev;
+    }
+}
+#else
+static uint64_t load_acquire(const volatile uint64_t * p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static void store_release(volatile uint64_t * p, const uint64_t val)
+{
+    __atomic_store_n(p, val, __ATOMIC_RELEASE);
+}
+#endif
+
+
+// XORs a word at a time (memcpy keeps the unaligned accesses legal)
+static void xor_bytes(
+    const uint8_t * psrc,
+    const uint8_t * pkey,
+    uint8_t * pdst,
+    const size_t sz)
+{
+    size_t jj = 0;
+
+    for (; (sz - jj) >= sizeof(uint64_t); jj += sizeof(uint64_t))
+    {
+        uint64_t a;
+        uint64_t b;
+        memcpy(&a, psrc + jj, sizeof(a));
+        memcpy(&b, pkey + jj, sizeof(b));
+        a ^= b;
+        memcpy(pdst + jj, &a, sizeof(a));
+    }
+
+    for (; jj < sz; jj++)
+    {
+        pdst[jj] = psrc[jj] ^ pkey[jj];
+    }
+}
+
+
+// sets up a ring that continues the keystream of a context
+// (the context is copied so it can be reused once this returns)
+// the buffer size must be a power of two
+// the producer tops the ring up to high_water once it drops to low_water
+// returns non-zero if the sizes are usable
+int wau8_ring_init(
+    wau8_ring_t * pring,
+    const wau8_context_t * pcontext,
+    uint8_t * pbuff,
+    const size_t sz,
+    const size_t low_water,
+    const size_t high_water)
+{
+    if ((sz == 0U) || ((sz & (sz - 1U)) != 0U) ||
+        (high_water > sz) || (low_water >= high_water))
+    {
+        return 0;
+    }
+
+    memset(pring, 0, sizeof(*pring));
+    pring->gen = *pcontext;
+    pring->con = *pcontext;
+    pring->head = pcontext->offset;
+    pring->tail = pcontext->offset;
+    pring->pbuff = pbuff;
+    pring->mask = sz - 1U;
+    pring->low_water = low_water;
+    pring->high_water = high_water;
+    return 1;
+}
+
+
+// returns number of keystream bytes ready for the consumer
+size_t wau8_ring_level(const wau8_ring_t * pring)
+{
+    uint64_t head = load_acquire(&pring->head);
+    uint64_t tail = load_acquire(&pring->tail);
+    return (head > tail) ? (size_t)(head - tail) : 0U;
+}
+
+
+// producer
+// does nothing unless the ring is at or below its low water mark
+// then makes keystream until it reaches its high water mark
+// publishing it WAU8_RING_STEP bytes at a time
+// returns number of bytes made, so a producer thread can back off when idle
+size_t wau8_ring_fill(wau8_ring_t * pring)
+{
+    const size_t ring_sz = pring->mask + 1U;
+    uint64_t head = pring->head;
+    uint64_t tail = load_acquire(&pring->tail);
+    size_t total = 0U;
+
+    // consumer ran dry and went past us
+    if (tail > head)
+    {
+        head = tail;
+        wau8_seek(&pring->gen, head);
+        store_release(&pring->head, head);
+    }
+
+    if ((size_t)(head - tail) > pring->low_water)
+    {
+        return 0U;
+    }
+
+    while ((size_t)(head - tail) < pring->high_water)
+    {
+        size_t start = (size_t)head & pring->mask;
+        size_t n = pring->high_water - (size_t)(head - tail);
+
+        if (n > WAU8_RING_STEP)
+        {
+            n = WAU8_RING_STEP;
+        }
+        if (n > (ring_sz - start))
+        {
+            n = ring_sz - start;
+        }
+
+        wau8_keystream(&pring->gen, pring->pbuff + start, n);
+        head += n;
+        total += n;
+        store_release(&pring->head, head);
+
+        tail = load_acquire(&pring->tail);
+        if (tail > head)
+        {
+            break;
+        }
+    }
+
+    return total;
+}
+
+
+// consumer
+// encrypts/decrypts with keystream from the ring
+// source and destination may be the same buffer
+// whatever the ring can't supply is made inline with the consumer's context
+// so the result always matches wau8_xor on the original context
+void wau8_ring_xor(
+    wau8_ring_t * pring,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz)
+{
+    const size_t ring_sz = pring->mask + 1U;
+    uint64_t tail = pring->tail;
+    uint64_t head = load_acquire(&pring->head);
+    size_t ready = (head > tail) ? (size_t)(head - tail) : 0U;
+    size_t done = 0U;
+
+    if (ready > sz)
+    {
+        ready = sz;
+    }
+
+    while (done < ready)
+    {
+        size_t start = (size_t)(tail + done) & pring->mask;
+        size_t n = ready - done;
+
+        if (n > (ring_sz - start))
+        {
+            n = ring_sz - start;
+        }
+
+        xor_bytes(psrc + done, pring->pbuff + start, pdst + done, n);
+        done += n;
+    }
+
+    if (done < sz)
+    {
+        wau8_seek(&pring->con, tail + done);
+        wau8_xor(&pring->con, psrc + done, pdst + done, sz - done);
+        pring->misses++;
+        pring->miss_bytes += (sz - done);
+    }
+
+    store_release(&pring->tail, tail + sz);
+}
+
+
+// returns keystream offset of the next byte the consumer will use
+uint64_t wau8_ring_get_offset(const wau8_ring_t * pring)
+{
+    return load_acquire(&pring->tail);
+}
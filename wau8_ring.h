@@ -0,0 +1,92 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#ifndef WAU8_RING_H_
+#define WAU8_RING_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "wau8.h"
+
+// bytes of keystream the producer makes before publishing them
+#define WAU8_RING_STEP          (4096U)
+
+// keeps the producer and consumer counters on separate cache lines
+#define WAU8_RING_LINE          (64U)
+
+// keystream made ahead of time by a producer into a ring buffer
+// one producer (wau8_ring_fill) and one consumer (wau8_ring_xor)
+// can run on different threads without locks
+// head and tail are absolute keystream offsets, head is only written
+// by the producer and tail only by the consumer
+// if the ring runs dry the consumer makes the rest of its keystream
+// itself and moves tail past head, the producer then skips ahead
+typedef struct
+{
+    // producer side
+    wau8_context_t gen;
+    volatile uint64_t head;
+    uint8_t pad0[WAU8_RING_LINE];
+
+    // consumer side
+    wau8_context_t con;
+    volatile uint64_t tail;
+    uint64_t misses;        // calls that had to make some keystream inline
+    uint64_t miss_bytes;    // bytes made inline
+    uint8_t pad1[WAU8_RING_LINE];
+
+    // set up once
+    uint8_t * pbuff;
+    size_t mask;
+    size_t low_water;
+    size_t high_water;
+} wau8_ring_t;
+
+
+int wau8_ring_init(
+    wau8_ring_t * pring,
+    const wau8_context_t * pcontext,
+    uint8_t * pbuff,
+    const size_t sz,
+    const size_t low_water,
+    const size_t high_water);
+size_t wau8_ring_level(const wau8_ring_t * pring);
+size_t wau8_ring_fill(wau8_ring_t * pring);
+void wau8_ring_xor(
+    wau8_ring_t * pring,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz);
+uint64_t wau8_ring_get_offset(const wau8_ring_t * pring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WAU8_RING_H_
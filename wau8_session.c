@@ -0,0 +1,152 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#include <string.h>
+#include "wau8_session.h"
+#include "wau8_util.h"
+
+
+// a saved session is just enough to rebuild a context on the same wheels
+// the key positions, the keystream offset, and an id for the wheels
+// everything is a byte or little-endian so it moves between machines
+static const uint8_t SESSION_MAGIC[4] = { 'W', 'A', 'U', '8' };
+
+
+static uint64_t fnv1a(uint64_t hash, const uint8_t * p, const size_t sz)
+{
+    size_t jj;
+    for (jj = 0; jj < sz; jj++)
+    {
+        hash ^= p[jj];
+        hash *= WAU8_FNV_PRIME;
+    }
+    return hash;
+}
+
+
+static void put_u64(uint8_t * p, const uint64_t val)
+{
+    unsigned int ii;
+    for (ii = 0; ii < 8U; ii++)
+    {
+        p[ii] = (uint8_t)(val >> (8U * ii));
+    }
+}
+
+
+static uint64_t get_u64(const uint8_t * p)
+{
+    uint64_t val = 0U;
+    unsigned int ii;
+    for (ii = 0; ii < 8U; ii++)
+    {
+        val |= ((uint64_t)p[ii]) << (8U * ii);
+    }
+    return val;
+}
+
+
+// identifies a set of wheels (64-bit FNV-1a over wheel sizes and values)
+// not a secret or a MAC, it only catches resuming on the wrong wheels
+#define GEN_HASH_WHEEL(nm, ix, sz) \
+    { \
+        const uint8_t sz_le[2] = { (uint8_t)(sz), (uint8_t)((sz) >> 8U) }; \
+        hash = fnv1a(hash, sz_le, sizeof(sz_le)); \
+        hash = fnv1a(hash, pwheels->nm, sz); \
+    }
+
+uint64_t wau8_wheels_id(const wau8_wheels_t * pwheels)
+{
+    uint64_t hash = WAU8_FNV_OFFSET_BASIS;
+    WAU8_WHEELS(GEN_HASH_WHEEL)
+    return hash;
+}
+
+
+// writes the state of a context so it can be picked up later with
+// wau8_session_load, possibly in another process
+// returns number of bytes written (WAU8_SESSION_SZ) or 0 if buffer is too small
+size_t wau8_session_save(
+    const wau8_context_t * pcontext,
+    uint8_t * pbuff,
+    const size_t sz)
+{
+    unsigned int ii;
+
+    if (sz < WAU8_SESSION_SZ)
+    {
+        return 0U;
+    }
+
+    memcpy(pbuff, SESSION_MAGIC, sizeof(SESSION_MAGIC));
+    pbuff[4] = (uint8_t)WAU8_SESSION_VERSION;
+    pbuff[5] = (uint8_t)WAU8_KEY_SZ;
+    for (ii = 0; ii < WAU8_KEY_SZ; ii++)
+    {
+        pbuff[6U + ii] = (uint8_t)pcontext->key[ii];
+    }
+    put_u64(pbuff + 6U + WAU8_KEY_SZ, pcontext->offset);
+    put_u64(pbuff + 14U + WAU8_KEY_SZ, wau8_wheels_id(pcontext->pwheels));
+
+    return WAU8_SESSION_SZ;
+}
+
+
+// sets the key and jumps the wheels straight to the saved offset
+// the context must already have its wheels (and any extended or fused
+// wheels) set, and they must be the wheels the session was saved with
+// the context is only changed if the session is usable
+wau8_session_status_t wau8_session_load(
+    wau8_context_t * pcontext,
+    const uint8_t * pbuff,
+    const size_t sz)
+{
+    uint8_t key[WAU8_KEY_SZ];
+    unsigned int ii;
+
+    if ((sz < WAU8_SESSION_SZ) ||
+        (memcmp(pbuff, SESSION_MAGIC, sizeof(SESSION_MAGIC)) != 0) ||
+        (pbuff[4] != WAU8_SESSION_VERSION) ||
+        (pbuff[5] != WAU8_KEY_SZ))
+    {
+        return WAU8_SESSION_BAD_FORMAT;
+    }
+
+    if (get_u64(pbuff + 14U + WAU8_KEY_SZ) != wau8_wheels_id(pcontext->pwheels))
+    {
+        return WAU8_SESSION_WRONG_WHEELS;
+    }
+
+    for (ii = 0; ii < WAU8_KEY_SZ; ii++)
+    {
+        key[ii] = pbuff[6U + ii];
+    }
+    wau8_set_key(pcontext, &key);
+    wau8_seek(pcontext, get_u64(pbuff + 6U + WAU8_KEY_SZ));
+
+    return WAU8_SESSION_OK;
+}
@@ -0,0 +1,67 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#ifndef WAU8_SESSION_H_
+#define WAU8_SESSION_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "wau8.h"
+
+// bytes in a saved session
+// magic (4), version (1), wheel count (1), key, offset (8), wheels id (8)
+// the key is in it as is, so a saved session is key material and
+// should be kept as private as the key itself
+#define WAU8_SESSION_SZ         (6U + WAU8_KEY_SZ + 8U + 8U)
+
+#define WAU8_SESSION_VERSION    (1U)
+
+typedef enum
+{
+    WAU8_SESSION_OK = 0,
+    WAU8_SESSION_BAD_FORMAT,    // not a session or from a different geometry
+    WAU8_SESSION_WRONG_WHEELS,  // saved with a different set of wheels
+} wau8_session_status_t;
+
+
+uint64_t wau8_wheels_id(const wau8_wheels_t * pwheels);
+size_t wau8_session_save(
+    const wau8_context_t * pcontext,
+    uint8_t * pbuff,
+    const size_t sz);
+wau8_session_status_t wau8_session_load(
+    wau8_context_t * pcontext,
+    const uint8_t * pbuff,
+    const size_t sz);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WAU8_SESSION_H_
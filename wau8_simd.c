@@ -0,0 +1,488 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#include "wau8_simd.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// on x86 every kernel gets built and the one to use is picked at run time
+// gcc and clang need each kernel marked with the instruction set it uses
+// msvc lets intrinsics be used anywhere
+#if defined(__x86_64__) || defined(__i386__)
+#define WAU8_HAVE_X86
+#define WAU8_TARGET(isa)        __attribute__((target(isa)))
+#elif defined(_M_X64) || defined(_M_IX86)
+#define WAU8_HAVE_X86
+#define WAU8_TARGET(isa)
+#endif
+
+#if defined(WAU8_HAVE_X86)
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+// all wheels advance by one each step so the next N encrypting/decrypting
+// bytes are the XOR of N consecutive values from each wheel
+// the extended wheels let each of those runs be a single unaligned load
+
+
+// runs of wheel values are read through pointers that move along with
+// the wheel positions so everything stays in registers across passes
+// vector blocks never go past WAU8_EXT_PAD so a pointer that moves past
+// the end of its wheel only needs to be pulled back by one wheel size
+#define GEN_INIT_PTR(nm, ix, sz) \
+    const uint8_t * p##nm = pxwheels->nm + pos[ix];
+#define GEN_ADVANCE_PTR(nm, ix, sz) \
+    p##nm += n; if (p##nm >= (pxwheels->nm + (sz))) { p##nm -= (sz); }
+#define GEN_SAVE_PTR(nm, ix, sz) \
+    pos[ix] = (unsigned int)(p##nm - pxwheels->nm);
+
+#define INIT_PTRS()     WAU8_WHEELS(GEN_INIT_PTR)
+#define ADVANCE_PTRS(count) \
+    { \
+        const unsigned int n = (count); \
+        WAU8_WHEELS(GEN_ADVANCE_PTR) \
+    }
+#define SAVE_PTRS()     WAU8_WHEELS(GEN_SAVE_PTR)
+
+// the vector kernels can't be used if any wheel is smaller than a block
+#define GEN_SMALL_WHEEL(nm, ix, sz)     || ((sz) < WAU8_EXT_PAD)
+#define HAS_SMALL_WHEEL                 (0 WAU8_WHEELS(GEN_SMALL_WHEEL))
+
+
+#if defined(WAU8_HAVE_X86)
+#define LOAD128(p)      _mm_loadu_si128((const __m128i *)(p))
+
+#define GEN_XOR64_SSE2(nm, ix, sz) \
+    k0 = _mm_xor_si128(k0, LOAD128(p##nm)); \
+    k1 = _mm_xor_si128(k1, LOAD128(p##nm + 16U)); \
+    k2 = _mm_xor_si128(k2, LOAD128(p##nm + 32U)); \
+    k3 = _mm_xor_si128(k3, LOAD128(p##nm + 48U));
+#define GEN_XOR16_SSE2(nm, ix, sz) \
+    k0 = _mm_xor_si128(k0, LOAD128(p##nm));
+
+WAU8_TARGET("sse2")
+size_t wau8_xor_sse2(
+    unsigned int pos[WAU8_KEY_SZ],
+    const wau8_ext_wheels_t * pxwheels,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz)
+{
+    size_t jj = 0;
+    INIT_PTRS()
+
+    // 64 bytes per pass so wheel positions only get updated once per pass
+    for (; (sz - jj) >= 64U; jj += 64U)
+    {
+        __m128i k0 = LOAD128(psrc + jj);
+        __m128i k1 = LOAD128(psrc + jj + 16U);
+        __m128i k2 = LOAD128(psrc + jj + 32U);
+        __m128i k3 = LOAD128(psrc + jj + 48U);
+        WAU8_WHEELS(GEN_XOR64_SSE2)
+        _mm_storeu_si128((__m128i *)(pdst + jj), k0);
+        _mm_storeu_si128((__m128i *)(pdst + jj + 16U), k1);
+        _mm_storeu_si128((__m128i *)(pdst + jj + 32U), k2);
+        _mm_storeu_si128((__m128i *)(pdst + jj + 48U), k3);
+        ADVANCE_PTRS(64U);
+    }
+
+    for (; (sz - jj) >= 16U; jj += 16U)
+    {
+        __m128i k0 = LOAD128(psrc + jj);
+        WAU8_WHEELS(GEN_XOR16_SSE2)
+        _mm_storeu_si128((__m128i *)(pdst + jj), k0);
+        ADVANCE_PTRS(16U);
+    }
+
+    SAVE_PTRS()
+    return jj;
+}
+
+
+#define LOAD256(p)      _mm256_loadu_si256((const __m256i *)(p))
+
+#define GEN_XOR64_AVX2(nm, ix, sz) \
+    k0 = _mm256_xor_si256(k0, LOAD256(p##nm)); \
+    k1 = _mm256_xor_si256(k1, LOAD256(p##nm + 32U));
+#define GEN_XOR32_AVX2(nm, ix, sz) \
+    k0 = _mm256_xor_si256(k0, LOAD256(p##nm));
+
+WAU8_TARGET("avx2")
+size_t wau8_xor_avx2(
+    unsigned int pos[WAU8_KEY_SZ],
+    const wau8_ext_wheels_t * pxwheels,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz)
+{
+    size_t jj = 0;
+    INIT_PTRS()
+
+    for (; (sz - jj) >= 64U; jj += 64U)
+    {
+        __m256i k0 = LOAD256(psrc + jj);
+        __m256i k1 = LOAD256(psrc + jj + 32U);
+        WAU8_WHEELS(GEN_XOR64_AVX2)
+        _mm256_storeu_si256((__m256i *)(pdst + jj), k0);
+        _mm256_storeu_si256((__m256i *)(pdst + jj + 32U), k1);
+        ADVANCE_PTRS(64U);
+    }
+
+    for (; (sz - jj) >= 32U; jj += 32U)
+    {
+        __m256i k0 = LOAD256(psrc + jj);
+        WAU8_WHEELS(GEN_XOR32_AVX2)
+        _mm256_storeu_si256((__m256i *)(pdst + jj), k0);
+        ADVANCE_PTRS(32U);
+    }
+
+    SAVE_PTRS()
+
+    // clear upper register state before any legacy sse code runs
+    // (gcc does not do this for target attribute functions and the
+    // transition penalty hits the sse2 tail and whatever the caller does next)
+    _mm256_zeroupper();
+    return jj + wau8_xor_sse2(pos, pxwheels, psrc + jj, pdst + jj, sz - jj);
+}
+
+
+#define LOAD512(p)      _mm512_loadu_si512((const void *)(p))
+
+#define GEN_XOR64_AVX512(nm, ix, sz) \
+    k0 = _mm512_xor_si512(k0, LOAD512(p##nm));
+
+WAU8_TARGET("avx512f")
+size_t wau8_xor_avx512(
+    unsigned int pos[WAU8_KEY_SZ],
+    const wau8_ext_wheels_t * pxwheels,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz)
+{
+    size_t jj = 0;
+    INIT_PTRS()
+
+    for (; (sz - jj) >= 64U; jj += 64U)
+    {
+        __m512i k0 = LOAD512(psrc + jj);
+        WAU8_WHEELS(GEN_XOR64_AVX512)
+        _mm512_storeu_si512((void *)(pdst + jj), k0);
+        ADVANCE_PTRS(64U);
+    }
+
+    SAVE_PTRS()
+    return jj + wau8_xor_avx2(pos, pxwheels, psrc + jj, pdst + jj, sz - jj);
+}
+
+
+// checks what the CPU and OS support
+static int cpu_has(const wau8_backend_t backend)
+{
+#if defined(_MSC_VER)
+    int regs[4];
+    int max_leaf;
+    unsigned long long xcr0 = 0U;
+
+    __cpuid(regs, 0);
+    max_leaf = regs[0];
+    __cpuid(regs, 1);
+    if (backend == WAU8_BACKEND_SSE2)
+    {
+        return (regs[3] & (1 << 26)) != 0;
+    }
+
+    // OS has to save the wider registers for AVX to be usable
+    if ((regs[2] & (1 << 27)) == 0)
+    {
+        return 0;
+    }
+    xcr0 = _xgetbv(0);
+    if (max_leaf < 7)
+    {
+        return 0;
+    }
+    __cpuidex(regs, 7, 0);
+    if (backend == WAU8_BACKEND_AVX2)
+    {
+        return ((xcr0 & 0x6U) == 0x6U) && ((regs[1] & (1 << 5)) != 0);
+    }
+    if (backend == WAU8_BACKEND_AVX512)
+    {
+        return ((xcr0 & 0xE6U) == 0xE6U) && ((regs[1] & (1 << 16)) != 0);
+    }
+    return 0;
+#else
+    __builtin_cpu_init();
+    switch (backend)
+    {
+    case WAU8_BACKEND_SSE2: return __builtin_cpu_supports("sse2");
+    case WAU8_BACKEND_AVX2: return __builtin_cpu_supports("avx2");
+    case WAU8_BACKEND_AVX512: return __builtin_cpu_supports("avx512f");
+    default: return 0;
+    }
+#endif
+}
+#else
+size_t wau8_xor_sse2(
+    unsigned int pos[WAU8_KEY_SZ],
+    const wau8_ext_wheels_t * pxwheels,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz)
+{
+    (void)pos;
+    (void)pxwheels;
+    (void)psrc;
+    (void)pdst;
+    (void)sz;
+    return 0U;
+}
+
+
+size_t wau8_xor_avx2(
+    unsigned int pos[WAU8_KEY_SZ],
+    const wau8_ext_wheels_t * pxwheels,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz)
+{
+    return wau8_xor_sse2(pos, pxwheels, psrc, pdst, sz);
+}
+
+
+size_t wau8_xor_avx512(
+    unsigned int pos[WAU8_KEY_SZ],
+    const wau8_ext_wheels_t * pxwheels,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz)
+{
+    return wau8_xor_sse2(pos, pxwheels, psrc, pdst, sz);
+}
+
+
+static int cpu_has(const wau8_backend_t backend)
+{
+    (void)backend;
+    return 0;
+}
+#endif
+
+
+typedef size_t (*xor_fn_t)(
+    unsigned int pos[WAU8_KEY_SZ],
+    const wau8_ext_wheels_t * pxwheels,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz);
+
+static const char * const BACKEND_NAMES[] =
+{
+    "auto",
+    "scalar",
+    "sse2",
+    "avx2",
+    "avx512",
+};
+
+// selection is made once on first use (or by wau8_set_backend)
+// it is one atomic word and the kernel is looked up from it on every call,
+// so threads racing on first use (e.g. wau8_xor_par's workers) never see
+// a backend without its kernel, and all store the same value anyway
+static long backend_sel = WAU8_BACKEND_AUTO;
+
+static wau8_backend_t load_backend(void)
+{
+#if defined(_MSC_VER)
+    return (wau8_backend_t)_InterlockedCompareExchange((volatile long *)&backend_sel, 0, 0);
+#else
+    return (wau8_backend_t)__atomic_load_n(&backend_sel, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static void store_backend(const wau8_backend_t backend)
+{
+#if defined(_MSC_VER)
+    _InterlockedExchange((volatile long *)&backend_sel, (long)backend);
+#else
+    __atomic_store_n(&backend_sel, (long)backend, __ATOMIC_RELEASE);
+#endif
+}
+
+
+static xor_fn_t backend_fn(const wau8_backend_t backend)
+{
+    switch (backend)
+    {
+    case WAU8_BACKEND_SSE2: return wau8_xor_sse2;
+    case WAU8_BACKEND_AVX2: return wau8_xor_avx2;
+    case WAU8_BACKEND_AVX512: return wau8_xor_avx512;
+    default: return NULL;
+    }
+}
+
+
+// backend named by the WAU8_BACKEND environment variable, if any
+static wau8_backend_t env_backend(void)
+{
+    wau8_backend_t result = WAU8_BACKEND_AUTO;
+    char * penv = NULL;
+    unsigned int ii;
+
+#if defined(_MSC_VER)
+    size_t len;
+    if (_dupenv_s(&penv, &len, "WAU8_BACKEND") != 0)
+    {
+        penv = NULL;
+    }
+#else
+    penv = getenv("WAU8_BACKEND");
+#endif
+
+    if (penv != NULL)
+    {
+        for (ii = 0; ii < (sizeof(BACKEND_NAMES) / sizeof(BACKEND_NAMES[0])); ii++)
+        {
+            if (strcmp(penv, BACKEND_NAMES[ii]) == 0)
+            {
+                result = (wau8_backend_t)ii;
+            }
+        }
+    }
+
+#if defined(_MSC_VER)
+    free(penv);
+#endif
+    return result;
+}
+
+
+// returns non-zero if backend can run on this machine
+int wau8_backend_available(const wau8_backend_t backend)
+{
+    if ((backend == WAU8_BACKEND_AUTO) || (backend == WAU8_BACKEND_SCALAR))
+    {
+        return 1;
+    }
+    return cpu_has(backend);
+}
+
+
+// picks a backend for the bulk functions
+// auto takes the environment variable if set and otherwise the fastest available
+// a backend the CPU lacks falls back to the next one down
+// returns the backend actually selected
+wau8_backend_t wau8_set_backend(const wau8_backend_t backend)
+{
+    wau8_backend_t sel = backend;
+
+    if (sel == WAU8_BACKEND_AUTO)
+    {
+        sel = env_backend();
+    }
+    if ((sel == WAU8_BACKEND_AUTO) || (sel > WAU8_BACKEND_AVX512))
+    {
+        sel = WAU8_BACKEND_AVX512;
+    }
+    while ((sel > WAU8_BACKEND_SCALAR) && !wau8_backend_available(sel))
+    {
+        sel = (wau8_backend_t)(sel - 1);
+    }
+
+    store_backend(sel);
+    return sel;
+}
+
+
+wau8_backend_t wau8_get_backend(void)
+{
+    wau8_backend_t sel = load_backend();
+
+    if (sel == WAU8_BACKEND_AUTO)
+    {
+        sel = wau8_set_backend(WAU8_BACKEND_AUTO);
+    }
+    return sel;
+}
+
+
+const char * wau8_backend_name(const wau8_backend_t backend)
+{
+    if ((unsigned int)backend < (sizeof(BACKEND_NAMES) / sizeof(BACKEND_NAMES[0])))
+    {
+        return BACKEND_NAMES[backend];
+    }
+    return "unknown";
+}
+
+
+// shares out the bytes a kernel did between the instruction sets that did them
+// (the wider kernels finish with the narrower ones, see above)
+// split is indexed by backend and gets the bytes for each
+void wau8_vec_split(
+    const wau8_backend_t backend,
+    const size_t vec_sz,
+    size_t split[WAU8_BACKEND_AVX512 + 1])
+{
+    size_t rest = vec_sz;
+
+    memset(split, 0, (WAU8_BACKEND_AVX512 + 1) * sizeof(size_t));
+    if (backend == WAU8_BACKEND_AVX512)
+    {
+        split[WAU8_BACKEND_AVX512] = rest & ~(size_t)63U;
+        rest -= split[WAU8_BACKEND_AVX512];
+    }
+    if (backend >= WAU8_BACKEND_AVX2)
+    {
+        split[WAU8_BACKEND_AVX2] = rest & ~(size_t)31U;
+        rest -= split[WAU8_BACKEND_AVX2];
+    }
+    split[(backend >= WAU8_BACKEND_SSE2) ? WAU8_BACKEND_SSE2 : WAU8_BACKEND_SCALAR] = rest;
+}
+
+
+// runs the selected kernel, returns 0 if the scalar backend is selected
+size_t wau8_xor_vec(
+    unsigned int pos[WAU8_KEY_SZ],
+    const wau8_ext_wheels_t * pxwheels,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz)
+{
+    xor_fn_t xor_fn = HAS_SMALL_WHEEL ? NULL : backend_fn(wau8_get_backend());
+
+    if (xor_fn == NULL)
+    {
+        return 0U;
+    }
+    return xor_fn(pos, pxwheels, psrc, pdst, sz);
+}
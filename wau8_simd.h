@@ -0,0 +1,71 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#ifndef WAU8_SIMD_H_
+#define WAU8_SIMD_H_
+
+#include "wau8.h"
+
+// vector kernels that use the extended wheels
+// each one processes as many whole vector blocks as fit in sz,
+// updates the wheel positions in pos, and returns the number of bytes done
+// the caller finishes any remaining bytes with the scalar loop
+
+size_t wau8_xor_sse2(
+    unsigned int pos[WAU8_KEY_SZ],
+    const wau8_ext_wheels_t * pxwheels,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz);
+
+size_t wau8_xor_avx2(
+    unsigned int pos[WAU8_KEY_SZ],
+    const wau8_ext_wheels_t * pxwheels,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz);
+
+size_t wau8_xor_avx512(
+    unsigned int pos[WAU8_KEY_SZ],
+    const wau8_ext_wheels_t * pxwheels,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz);
+
+size_t wau8_xor_vec(
+    unsigned int pos[WAU8_KEY_SZ],
+    const wau8_ext_wheels_t * pxwheels,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz);
+
+void wau8_vec_split(
+    const wau8_backend_t backend,
+    const size_t vec_sz,
+    size_t split[WAU8_BACKEND_AVX512 + 1]);
+
+#endif // WAU8_SIMD_H_
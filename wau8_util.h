@@ -0,0 +1,61 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#ifndef WAU8_UTIL_H_
+#define WAU8_UTIL_H_
+
+// small helpers shared by the library sources (not part of the API)
+
+#include <stdint.h>
+
+// moves a wheel position ahead by one and handles wraparound
+// without having to do modulo or use an if-block (compiles to a conditional move)
+#define WAU8_WRAP_INC(pos, sz)      ((((pos) + 1U) == (sz)) ? 0U : ((pos) + 1U))
+
+// converts a 64-bit word to or from little-endian
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define WAU8_LE64(x)                __builtin_bswap64(x)
+#else
+#define WAU8_LE64(x)                (x)
+#endif
+
+// 64-bit FNV-1a
+#define WAU8_FNV_OFFSET_BASIS       (0xCBF29CE484222325ULL)
+#define WAU8_FNV_PRIME              (0x00000100000001B3ULL)
+
+// splitmix64: the n-th value from a seed is wau8_mix64(seed + n * WAU8_MIX_GAMMA)
+// so values can be made in any order with no state carried between them
+#define WAU8_MIX_GAMMA              (0x9E3779B97F4A7C15ULL)
+
+static inline uint64_t wau8_mix64(uint64_t z)
+{
+    z = (z ^ (z >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27U)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31U);
+}
+
+#endif // WAU8_UTIL_H_
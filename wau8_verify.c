@@ -0,0 +1,462 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "wau8_verify.h"
+#include "wau8_util.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+
+// all wheels step together so after t steps wheel i is at (p[i] + t) mod s[i]
+// - the joint positions repeat after lcm(s) steps (the period)
+// - from a given start, joint position q is reached if and only if
+//   q[i] - p[i] == q[j] - p[j] modulo gcd(s[i], s[j]) for every pair
+//   (generalized chinese remainder theorem)
+// - so every joint position is reached exactly when the sizes are
+//   pairwise relatively prime and the period is the product of the sizes
+// the exhaustive check walks the whole period marking a bitset of joint
+// positions, the sampled check picks random joint positions, solves for
+// the step that reaches them, and checks the wheels really land there
+
+#define CHUNKS_PER_THREAD   (16)
+
+
+static uint64_t gcd64(uint64_t a, uint64_t b)
+{
+    while (b != 0U)
+    {
+        uint64_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+
+// inverse of x modulo m, x and m relatively prime and m small
+static uint64_t inv_small(const uint64_t x, const uint64_t m)
+{
+    int64_t t0 = 0;
+    int64_t t1 = 1;
+    int64_t r0 = (int64_t)m;
+    int64_t r1 = (int64_t)(x % m);
+
+    while (r1 != 0)
+    {
+        int64_t q = r0 / r1;
+        int64_t tmp;
+        tmp = t0 - (q * t1); t0 = t1; t1 = tmp;
+        tmp = r0 - (q * r1); r0 = r1; r1 = tmp;
+    }
+
+    return (uint64_t)((t0 < 0) ? (t0 + (int64_t)m) : t0);
+}
+
+
+static unsigned int popcount64(const uint64_t x)
+{
+#if defined(__GNUC__)
+    return (unsigned int)__builtin_popcountll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return (unsigned int)__popcnt64(x);
+#else
+    uint64_t v = x;
+    unsigned int n = 0U;
+    while (v != 0U)
+    {
+        v &= (v - 1U);
+        n++;
+    }
+    return n;
+#endif
+}
+
+
+// log2 of the lcm from the prime factorization of the sizes
+// (the lcm itself may not fit in 64 bits)
+static double log2_lcm(const uint16_t * psizes, const size_t count)
+{
+    // wheel sizes are 16 bits so each has at most 6 distinct prime factors
+    uint32_t * pprimes = (uint32_t *)malloc(count * 6U * sizeof(uint32_t));
+    unsigned int * pexps = (unsigned int *)malloc(count * 6U * sizeof(unsigned int));
+    size_t nprimes = 0U;
+    double result = 0.0;
+    size_t ii;
+    size_t kk;
+
+    if ((pprimes == NULL) || (pexps == NULL))
+    {
+        free(pprimes);
+        free(pexps);
+        return -1.0;
+    }
+
+    for (ii = 0; ii < count; ii++)
+    {
+        uint32_t n = psizes[ii];
+        uint32_t p;
+
+        for (p = 2U; n > 1U; p++)
+        {
+            unsigned int e = 0U;
+
+            if ((p * p) > n)
+            {
+                p = n;
+            }
+            while ((n % p) == 0U)
+            {
+                n /= p;
+                e++;
+            }
+            if (e == 0U)
+            {
+                continue;
+            }
+
+            for (kk = 0; (kk < nprimes) && (pprimes[kk] != p); kk++)
+            {
+            }
+            if (kk == nprimes)
+            {
+                pprimes[kk] = p;
+                pexps[kk] = 0U;
+                nprimes++;
+            }
+            if (e > pexps[kk])
+            {
+                pexps[kk] = e;
+            }
+        }
+    }
+
+    for (kk = 0; kk < nprimes; kk++)
+    {
+        result += (double)pexps[kk] * log2((double)pprimes[kk]);
+    }
+
+    free(pprimes);
+    free(pexps);
+    return result;
+}
+
+
+// walks every step of the period marking the joint positions reached
+// joint position is a mixed-radix number with one digit per wheel
+// returns number of distinct joint positions marked, or 0 if out of memory
+static uint64_t check_exhaustive(
+    const uint16_t * psizes,
+    const size_t count,
+    const uint64_t period,
+    const uint64_t states,
+    const int nthreads)
+{
+    const size_t nwords = (size_t)((states + 63U) / 64U);
+    uint64_t * pbits = (uint64_t *)calloc(nwords, sizeof(uint64_t));
+    uint64_t * pstrides = (uint64_t *)malloc(count * sizeof(uint64_t));
+    const ptrdiff_t nchunks = (ptrdiff_t)nthreads * CHUNKS_PER_THREAD;
+    const uint64_t chunk_sz = (period + (uint64_t)nchunks - 1U) / (uint64_t)nchunks;
+    uint64_t marked = 0U;
+    ptrdiff_t cc;
+    ptrdiff_t ww;
+    size_t ii;
+
+    if ((pbits == NULL) || (pstrides == NULL))
+    {
+        free(pbits);
+        free(pstrides);
+        return 0U;
+    }
+
+    pstrides[0] = 1U;
+    for (ii = 1; ii < count; ii++)
+    {
+        pstrides[ii] = pstrides[ii - 1U] * psizes[ii - 1U];
+    }
+
+#pragma omp parallel for schedule(static) num_threads(nthreads)
+    for (cc = 0; cc < nchunks; cc++)
+    {
+        uint32_t pos[64];
+        uint64_t t0 = (uint64_t)cc * chunk_sz;
+        uint64_t t1 = (t0 + chunk_sz < period) ? (t0 + chunk_sz) : period;
+        uint64_t idx = 0U;
+        uint64_t tt;
+        size_t jj;
+
+        if (t0 >= t1)
+        {
+            continue;
+        }
+
+        for (jj = 0; jj < count; jj++)
+        {
+            pos[jj] = (uint32_t)(t0 % psizes[jj]);
+            idx += pos[jj] * pstrides[jj];
+        }
+
+        for (tt = t0; tt < t1; tt++)
+        {
+            const uint64_t mask = 1ULL << (idx & 63U);
+#pragma omp atomic
+            pbits[idx >> 6U] |= mask;
+
+            for (jj = 0; jj < count; jj++)
+            {
+                pos[jj]++;
+                idx += pstrides[jj];
+                if (pos[jj] == psizes[jj])
+                {
+                    pos[jj] = 0U;
+                    idx -= psizes[jj] * pstrides[jj];
+                }
+            }
+        }
+    }
+
+#pragma omp parallel for schedule(static) num_threads(nthreads) reduction(+:marked)
+    for (ww = 0; ww < (ptrdiff_t)nwords; ww++)
+    {
+        marked += popcount64(pbits[ww]);
+    }
+
+    free(pbits);
+    free(pstrides);
+    return marked;
+}
+
+
+// checks random joint positions against the theory
+// returns number of failures
+static uint64_t check_sampled(
+    const uint16_t * psizes,
+    const size_t count,
+    const uint64_t samples,
+    const int nthreads)
+{
+    uint64_t failures = 0U;
+    ptrdiff_t ss;
+
+#pragma omp parallel for schedule(static) num_threads(nthreads) reduction(+:failures)
+    for (ss = 0; ss < (ptrdiff_t)samples; ss++)
+    {
+        uint32_t q[64];
+        uint64_t a = 0U;    // step that reaches q[0..jj) ...
+        uint64_t m = 1U;    // ... modulo the lcm of those sizes
+        int crt_ok = 1;
+        int pair_ok = 1;
+        size_t ii;
+        size_t jj;
+
+        for (jj = 0; jj < count; jj++)
+        {
+            q[jj] = (uint32_t)(wau8_mix64(((uint64_t)ss * count + jj + 1U) * WAU8_MIX_GAMMA) % psizes[jj]);
+        }
+
+        // what the pairwise condition says
+        for (ii = 0; ii < count; ii++)
+        {
+            for (jj = ii + 1U; jj < count; jj++)
+            {
+                uint64_t g = gcd64(psizes[ii], psizes[jj]);
+                if ((q[ii] % g) != (q[jj] % g))
+                {
+                    pair_ok = 0;
+                }
+            }
+        }
+
+        // solve t == q[jj] mod psizes[jj] one wheel at a time
+        for (jj = 0; (jj < count) && crt_ok; jj++)
+        {
+            uint64_t s = psizes[jj];
+            uint64_t g = gcd64(m % s, s);
+            uint64_t n = s / g;
+            uint64_t diff = ((uint64_t)q[jj] + s - (a % s)) % s;
+
+            if ((m % s) == 0U)
+            {
+                g = s;
+                n = 1U;
+            }
+
+            if ((diff % g) != 0U)
+            {
+                crt_ok = 0;
+            }
+            else
+            {
+                uint64_t k = ((diff / g) * inv_small((m / g) % n, n)) % n;
+                a += m * k;
+                m *= n;
+            }
+        }
+
+        if (crt_ok != pair_ok)
+        {
+            failures++;
+        }
+        else if (crt_ok)
+        {
+            // the wheels really are at q after a steps
+            for (jj = 0; jj < count; jj++)
+            {
+                if ((a % psizes[jj]) != q[jj])
+                {
+                    failures++;
+                    break;
+                }
+            }
+        }
+    }
+
+    return failures;
+}
+
+
+void wau8_verify_init_cfg(wau8_verify_cfg_t * pcfg)
+{
+    pcfg->max_bits = WAU8_VERIFY_MAX_BITS;
+    pcfg->samples = WAU8_VERIFY_SAMPLES;
+    pcfg->nthreads = 0;
+}
+
+
+// works out the period and coverage of a list of wheel sizes
+// and checks them exhaustively if the joint position space is small enough
+// or by sampling random joint positions if it isn't
+// (pass WAU8_WHEEL_SZ and WAU8_KEY_SZ to check the compiled-in geometry)
+// at most 64 wheels
+void wau8_verify(
+    const uint16_t * psizes,
+    const size_t count,
+    const wau8_verify_cfg_t * pcfg,
+    wau8_verify_result_t * presult)
+{
+    wau8_verify_cfg_t cfg;
+    int period_fits = 1;
+    int states_fit = 1;
+    uint64_t period = 1U;
+    uint64_t states = 1U;
+    size_t ii;
+    size_t jj;
+
+    memset(presult, 0, sizeof(*presult));
+    if ((count == 0U) || (count > 64U))
+    {
+        return;
+    }
+    for (ii = 0; ii < count; ii++)
+    {
+        if (psizes[ii] == 0U)
+        {
+            return;
+        }
+    }
+
+    if (pcfg != NULL)
+    {
+        cfg = *pcfg;
+    }
+    else
+    {
+        wau8_verify_init_cfg(&cfg);
+    }
+    if (cfg.nthreads <= 0)
+    {
+        cfg.nthreads = 1;
+#ifdef _OPENMP
+        cfg.nthreads = omp_get_max_threads();
+#endif
+    }
+
+    presult->full_coverage = 1;
+    for (ii = 0; ii < count; ii++)
+    {
+        uint64_t g = gcd64(period, psizes[ii]);
+
+        presult->log2_states += log2((double)psizes[ii]);
+
+        if (states > (UINT64_MAX / psizes[ii]))
+        {
+            states_fit = 0;
+        }
+        states *= psizes[ii];
+
+        if ((period / g) > (UINT64_MAX / psizes[ii]))
+        {
+            period_fits = 0;
+        }
+        period = (period / g) * psizes[ii];
+
+        for (jj = ii + 1U; jj < count; jj++)
+        {
+            if (presult->full_coverage && (gcd64(psizes[ii], psizes[jj]) != 1U))
+            {
+                presult->full_coverage = 0;
+                presult->share_i = ii;
+                presult->share_j = jj;
+            }
+        }
+    }
+
+    presult->log2_period = log2_lcm(psizes, count);
+    presult->period = period_fits ? period : 0U;
+    presult->states = states_fit ? states : 0U;
+
+    if (states_fit && (states <= cfg.max_bits))
+    {
+        uint64_t marked = check_exhaustive(psizes, count, period, states, cfg.nthreads);
+        if (marked != 0U)
+        {
+            presult->exhaustive = 1;
+            presult->checked = states;
+            presult->failures = (marked > period) ? (marked - period) : (period - marked);
+            if (presult->full_coverage && (marked != states))
+            {
+                presult->failures++;
+            }
+            return;
+        }
+    }
+
+    // solving for the step needs the period to fit in 64 bits
+    if (period_fits)
+    {
+        presult->checked = cfg.samples;
+        presult->failures = check_sampled(psizes, count, cfg.samples, cfg.nthreads);
+    }
+}
@@ -0,0 +1,77 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#ifndef WAU8_VERIFY_H_
+#define WAU8_VERIFY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "wau8.h"
+
+// largest joint position space checked exhaustively by default
+// (one bit per joint position, 2^30 bits is 128 MB)
+#define WAU8_VERIFY_MAX_BITS    (1ULL << 30U)
+
+// number of random joint positions checked when the space is too big
+#define WAU8_VERIFY_SAMPLES     (1000000ULL)
+
+typedef struct
+{
+    uint64_t max_bits;  // exhaustive check up to this many joint positions
+    uint64_t samples;   // otherwise check this many random ones
+    int nthreads;       // 0 uses the OpenMP default
+} wau8_verify_cfg_t;
+
+typedef struct
+{
+    uint64_t period;        // steps before joint positions repeat, 0 if > 64 bits
+    uint64_t states;        // number of joint positions, 0 if > 64 bits
+    double log2_period;
+    double log2_states;
+    int full_coverage;      // non-zero if every joint position is reached
+    size_t share_i;         // first pair of wheels whose sizes share a factor
+    size_t share_j;         // (only set if coverage isn't full)
+    int exhaustive;         // non-zero if every joint position was checked
+    uint64_t checked;       // joint positions checked
+    uint64_t failures;      // checks that disagreed with the theory
+} wau8_verify_result_t;
+
+
+void wau8_verify_init_cfg(wau8_verify_cfg_t * pcfg);
+void wau8_verify(
+    const uint16_t * psizes,
+    const size_t count,
+    const wau8_verify_cfg_t * pcfg,
+    wau8_verify_result_t * presult);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WAU8_VERIFY_H_
@@ -0,0 +1,426 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+// command-line tool for wau8_arc archives
+// -c makes an archive from a file or stream, -x decrypts all of an
+// archive or just a byte range of it, -l shows what an archive holds
+// POSIX only
+
+#define _FILE_OFFSET_BITS 64
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "wau8.h"
+#include "wau8_arc.h"
+
+// bytes decrypted per pass when extracting, rounded to whole blocks
+#define EXTRACT_SZ          (64U << 20U)
+
+#define READ_SZ             (1U << 20U)
+
+static wau8_wheels_t wheels;
+static wau8_ext_wheels_t xwheels;
+
+static const char * const STATUS_NAMES[] =
+{
+    "ok",
+    "read or write failed",
+    "out of memory",
+    "not an archive",
+    "archive was made with different wheels",
+    "damaged block",
+    "range is past the end of the data",
+};
+
+
+static void usage(void)
+{
+    fprintf(stderr,
+        "usage: wau8arc -c|-x|-l -i FILE [-o FILE] [-k KEY -w WHEELS|-s SEED] [options]\n"
+        "  -c          make an archive\n"
+        "  -x          decrypt an archive\n"
+        "  -l          show the header of an archive\n"
+        "  -k KEY      key as 16 hex digits\n"
+        "  -w WHEELS   file holding a raw wau8_wheels_t (%u bytes)\n"
+        "  -s SEED     make wheels from a seed with wau8_make_wheels instead\n"
+        "  -i FILE     input file (-c reads stdin if -)\n"
+        "  -o FILE     output file (default stdout)\n"
+        "  -B BYTES    block size for -c (default %u)\n"
+        "  -I ID       key id to store with -c\n"
+        "  -O OFFSET   keystream offset of the first byte for -c (default 0)\n"
+        "  -r POS:LEN  decrypt only LEN bytes from POS with -x\n"
+        "  -t THREADS  threads for -x (default OpenMP default)\n",
+        (unsigned int)sizeof(wau8_wheels_t),
+        WAU8_ARC_BLOCK_SZ);
+}
+
+
+static int parse_key(const char * s, uint8_t key[WAU8_KEY_SZ])
+{
+    unsigned int ii;
+
+    if (strlen(s) != (2U * WAU8_KEY_SZ))
+    {
+        return -1;
+    }
+
+    for (ii = 0; ii < WAU8_KEY_SZ; ii++)
+    {
+        char hex[3] = { s[2U * ii], s[(2U * ii) + 1U], 0 };
+        char * pend;
+        key[ii] = (uint8_t)strtoul(hex, &pend, 16);
+        if (*pend != 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+static int load_wheels(const char * path)
+{
+    FILE * pf = fopen(path, "rb");
+    size_t n;
+
+    if (pf == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    n = fread(&wheels, 1U, sizeof(wheels), pf);
+    fclose(pf);
+    if (n != sizeof(wheels))
+    {
+        fprintf(stderr, "%s: expected %u bytes of wheel data\n",
+            path, (unsigned int)sizeof(wheels));
+        return -1;
+    }
+
+    return 0;
+}
+
+
+// archive callbacks on a file descriptor
+// the writer only ever appends, so writes go out in order with write()
+// and the output can be a pipe, reads use pread so they can run in parallel
+typedef struct
+{
+    int fd;
+    uint64_t pos;       // bytes written so far
+} out_t;
+
+static int write_all(int fd, const uint8_t * p, size_t len)
+{
+    while (len > 0U)
+    {
+        ssize_t n = write(fd, p, len);
+        if (n <= 0)
+        {
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+
+static int fd_append(void * parg, const uint64_t pos, const uint8_t * p, const size_t sz)
+{
+    out_t * pout = (out_t *)parg;
+
+    if ((pos != pout->pos) || (write_all(pout->fd, p, sz) != 0))
+    {
+        return -1;
+    }
+    pout->pos += sz;
+    return 0;
+}
+
+
+static int fd_read(void * parg, const uint64_t pos, uint8_t * p, const size_t sz)
+{
+    const int fd = *(const int *)parg;
+    size_t done = 0U;
+
+    while (done < sz)
+    {
+        ssize_t n = pread(fd, p + done, sz - done, (off_t)(pos + done));
+        if (n <= 0)
+        {
+            return -1;
+        }
+        done += (size_t)n;
+    }
+    return 0;
+}
+
+
+static int create(
+    const wau8_context_t * pcontext,
+    int ifd,
+    int ofd,
+    const uint32_t block_sz,
+    const uint64_t key_id)
+{
+    wau8_arc_writer_t writer;
+    wau8_arc_status_t status;
+    uint8_t * pbuff = (uint8_t *)malloc(READ_SZ);
+    out_t out = { ofd, 0U };
+    ssize_t n = 0;
+
+    status = wau8_arc_writer_init(&writer, pcontext, block_sz, key_id, fd_append, &out);
+    while ((status == WAU8_ARC_OK) && (pbuff != NULL))
+    {
+        n = read(ifd, pbuff, READ_SZ);
+        if (n <= 0)
+        {
+            break;
+        }
+        status = wau8_arc_write(&writer, pbuff, (size_t)n);
+    }
+
+    if (n < 0)
+    {
+        perror("read");
+        status = WAU8_ARC_IO;
+    }
+    if (status == WAU8_ARC_OK)
+    {
+        status = wau8_arc_writer_finish(&writer);
+    }
+    else
+    {
+        wau8_arc_writer_finish(&writer);
+    }
+
+    free(pbuff);
+    if (status != WAU8_ARC_OK)
+    {
+        fprintf(stderr, "wau8arc: %s\n", STATUS_NAMES[status]);
+        return -1;
+    }
+    return 0;
+}
+
+
+static int extract(
+    const wau8_context_t * pcontext,
+    wau8_arc_reader_t * preader,
+    int ofd,
+    uint64_t pos,
+    uint64_t len,
+    const int nthreads)
+{
+    const size_t pass_sz = (EXTRACT_SZ / preader->block_sz + 1U) * preader->block_sz;
+    uint8_t * pbuff = (uint8_t *)malloc(pass_sz);
+    wau8_arc_status_t status = WAU8_ARC_OK;
+
+    if (pbuff == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        return -1;
+    }
+
+    while ((len > 0U) && (status == WAU8_ARC_OK))
+    {
+        size_t n = (len < pass_sz) ? (size_t)len : pass_sz;
+
+        status = wau8_arc_read(preader, pcontext, pos, pbuff, n, nthreads);
+        if ((status == WAU8_ARC_OK) && (write_all(ofd, pbuff, n) != 0))
+        {
+            perror("write");
+            free(pbuff);
+            return -1;
+        }
+        pos += n;
+        len -= n;
+    }
+
+    free(pbuff);
+    if (status != WAU8_ARC_OK)
+    {
+        fprintf(stderr, "wau8arc: %s\n", STATUS_NAMES[status]);
+        return -1;
+    }
+    return 0;
+}
+
+
+int main(int argc, char* argv[])
+{
+    const char * ipath = NULL;
+    const char * opath = NULL;
+    const char * wpath = NULL;
+    const char * seed_str = NULL;
+    const char * kstr = NULL;
+    const char * range = NULL;
+    uint32_t block_sz = WAU8_ARC_BLOCK_SZ;
+    uint64_t key_id = 0U;
+    uint64_t offset = 0U;
+    uint8_t key[WAU8_KEY_SZ];
+    wau8_arc_reader_t reader;
+    wau8_arc_status_t status;
+    wau8_context_t con;
+    struct stat ist;
+    int mode = 0;
+    int nthreads = 0;
+    int ifd = STDIN_FILENO;
+    int ofd = STDOUT_FILENO;
+    int result;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "cxlk:w:s:i:o:B:I:O:r:t:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'c':
+        case 'x':
+        case 'l': mode = opt; break;
+        case 'k': kstr = optarg; break;
+        case 'w': wpath = optarg; break;
+        case 's': seed_str = optarg; break;
+        case 'i': ipath = optarg; break;
+        case 'o': opath = optarg; break;
+        case 'B': block_sz = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'I': key_id = strtoull(optarg, NULL, 0); break;
+        case 'O': offset = strtoull(optarg, NULL, 0); break;
+        case 'r': range = optarg; break;
+        case 't': nthreads = atoi(optarg); break;
+        default: usage(); return 2;
+        }
+    }
+
+    if ((mode == 0) || (ipath == NULL) ||
+        ((mode != 'l') && ((kstr == NULL) || ((wpath == NULL) == (seed_str == NULL)))))
+    {
+        usage();
+        return 2;
+    }
+
+    if ((kstr != NULL) && (parse_key(kstr, key) != 0))
+    {
+        fprintf(stderr, "key must be %u hex digits\n", 2U * WAU8_KEY_SZ);
+        return 2;
+    }
+
+    if (mode != 'l')
+    {
+        if (seed_str != NULL)
+        {
+            wau8_make_wheels(&wheels, strtoull(seed_str, NULL, 0));
+        }
+        else if (load_wheels(wpath) != 0)
+        {
+            return 1;
+        }
+        wau8_make_ext_wheels(&xwheels, &wheels);
+        wau8_set_wheels(&con, &wheels);
+        wau8_set_ext_wheels(&con, &xwheels);
+        wau8_set_key(&con, &key);
+        wau8_seek(&con, offset);
+    }
+
+    if (strcmp(ipath, "-") != 0)
+    {
+        ifd = open(ipath, O_RDONLY);
+        if (ifd < 0)
+        {
+            perror(ipath);
+            return 1;
+        }
+    }
+
+    if ((opath != NULL) && (strcmp(opath, "-") != 0))
+    {
+        ofd = open(opath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (ofd < 0)
+        {
+            perror(opath);
+            return 1;
+        }
+    }
+
+    if (mode == 'c')
+    {
+        result = create(&con, ifd, ofd, block_sz, key_id);
+    }
+    else
+    {
+        uint64_t pos = 0U;
+        uint64_t len;
+
+        fstat(ifd, &ist);
+        status = wau8_arc_reader_open(&reader, fd_read, &ifd, (uint64_t)ist.st_size);
+        if (status != WAU8_ARC_OK)
+        {
+            fprintf(stderr, "%s: %s\n", ipath, STATUS_NAMES[status]);
+            return 1;
+        }
+
+        len = reader.data_sz;
+        if (range != NULL)
+        {
+            char * pend;
+            pos = strtoull(range, &pend, 0);
+            len = (*pend == ':') ? strtoull(pend + 1, NULL, 0) : (reader.data_sz - pos);
+        }
+
+        if (mode == 'l')
+        {
+            printf("data:        %llu bytes in %llu blocks of %u\n",
+                (unsigned long long)reader.data_sz,
+                (unsigned long long)reader.count,
+                reader.block_sz);
+            printf("key id:      %llu\n", (unsigned long long)reader.key_id);
+            printf("wheels id:   %016llx\n", (unsigned long long)reader.wheels_id);
+            printf("offset:      %llu\n", (unsigned long long)reader.base_offset);
+            result = 0;
+        }
+        else
+        {
+            result = extract(&con, &reader, ofd, pos, len, nthreads);
+        }
+        wau8_arc_reader_close(&reader);
+    }
+
+    if ((ofd != STDOUT_FILENO) && (close(ofd) != 0))
+    {
+        perror("close");
+        result = -1;
+    }
+
+    return (result == 0) ? 0 : 1;
+}
@@ -0,0 +1,597 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+// command-line tool for auditing how quickly a key can be found for a
+// set of wheels from known plaintext (known keystream)
+//
+// the keystream byte at step t is the XOR of each wheel's value at
+// (key[i] + t) mod size[i], so the first 8 bytes are the XOR of one
+// 64-bit "contribution" per wheel that only depends on that wheel's key
+// - contributions are precomputed for every position of every wheel
+// - the last few wheels go in a hash table keyed by the XOR of their
+//   contributions (meet in the middle)
+// - the other wheels are enumerated in parallel, and each combination
+//   needs one table lookup to check every key for the table wheels
+// - anything that matches 8 bytes is confirmed against all known bytes
+// with -L the search stops early and the time for the rest is projected
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "wau8.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define MAX_KNOWN           (4096U)
+#define DEFAULT_TABLE_MB    (256U)
+#define EMPTY_SLOT          (0xFFFFFFFFU)
+#define MAX_ENTRIES         (0xFFFFFFFEULL)    // entry numbers stay below EMPTY_SLOT
+#define SLOT_BYTES          (sizeof(uint64_t) + sizeof(uint32_t))
+#define MAX_FOUND           (16U)
+
+
+typedef struct
+{
+    uint64_t * pkeys;       // XOR of the table wheels' contributions
+    uint32_t * pidx;        // table wheel positions as a mixed-radix number
+    uint64_t mask;
+} table_t;
+
+
+static wau8_wheels_t wheels;
+static uint8_t known[MAX_KNOWN];
+static size_t nknown = 0U;
+static uint64_t known_offset = 0U;
+static uint64_t known_word = 0U;    // first 8 known bytes (fewer if short)
+static uint64_t known_mask = 0U;
+static uint64_t * pcontrib[WAU8_KEY_SZ];
+static table_t table;
+static size_t nsplit = 0U;          // wheels [0, nsplit) are enumerated
+static size_t nouter = 0U;          // wheels [0, nouter) pick the slice
+static uint8_t found[MAX_FOUND][WAU8_KEY_SZ];
+static size_t nfound = 0U;
+
+
+static double now(void)
+{
+#ifdef _OPENMP
+    return omp_get_wtime();
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+
+// where a stream of n known bytes starting at known_offset would come from
+// for each position of each wheel, packed little-endian into a word
+#define GEN_CONTRIB(nm, ix, sz) \
+    for (pp = 0; pp < (sz); pp++) \
+    { \
+        uint64_t val = 0U; \
+        for (tt = 0; tt < nword; tt++) \
+        { \
+            val |= (uint64_t)wheels.nm[(pp + known_offset + tt) % (sz)] << (8U * tt); \
+        } \
+        pcontrib[ix][pp] = val; \
+    }
+
+static int make_contrib(void)
+{
+    const size_t nword = (nknown < 8U) ? nknown : 8U;
+    uint64_t pp;
+    uint64_t tt;
+    size_t ii;
+
+    for (ii = 0; ii < WAU8_KEY_SZ; ii++)
+    {
+        pcontrib[ii] = (uint64_t *)malloc(WAU8_WHEEL_SZ[ii] * sizeof(uint64_t));
+        if (pcontrib[ii] == NULL)
+        {
+            return -1;
+        }
+    }
+
+    WAU8_WHEELS(GEN_CONTRIB)
+
+    known_word = 0U;
+    for (tt = 0; tt < nword; tt++)
+    {
+        known_word |= (uint64_t)known[tt] << (8U * tt);
+    }
+    known_mask = (nword == 8U) ? UINT64_MAX : ((1ULL << (8U * nword)) - 1U);
+    return 0;
+}
+
+
+static uint64_t table_slot(const uint64_t key)
+{
+    return ((key * 0x9E3779B97F4A7C15ULL) >> 32U) & table.mask;
+}
+
+
+// slots in a table for this many entries
+// a power of two at least twice the entries, so at most half full
+static uint64_t table_slots(const uint64_t entries)
+{
+    uint64_t slots = 1U;
+
+    while (slots < (2U * entries))
+    {
+        slots <<= 1U;
+    }
+    return slots;
+}
+
+
+// puts every combination of positions of wheels [nsplit, WAU8_KEY_SZ)
+// in the table, returns number of entries or 0 if out of memory
+static uint64_t make_table(void)
+{
+    uint64_t entries = 1U;
+    uint64_t slots;
+    uint64_t ee;
+    size_t ii;
+
+    for (ii = nsplit; ii < WAU8_KEY_SZ; ii++)
+    {
+        entries *= WAU8_WHEEL_SZ[ii];
+    }
+    slots = table_slots(entries);
+
+    table.pkeys = (uint64_t *)malloc(slots * sizeof(uint64_t));
+    table.pidx = (uint32_t *)malloc(slots * sizeof(uint32_t));
+    if ((table.pkeys == NULL) || (table.pidx == NULL))
+    {
+        return 0U;
+    }
+    memset(table.pidx, 0xFF, slots * sizeof(uint32_t));
+    table.mask = slots - 1U;
+
+    for (ee = 0; ee < entries; ee++)
+    {
+        uint64_t rest = ee;
+        uint64_t key = 0U;
+        uint64_t slot;
+
+        for (ii = nsplit; ii < WAU8_KEY_SZ; ii++)
+        {
+            key ^= pcontrib[ii][rest % WAU8_WHEEL_SZ[ii]];
+            rest /= WAU8_WHEEL_SZ[ii];
+        }
+        key &= known_mask;
+
+        for (slot = table_slot(key); table.pidx[slot] != EMPTY_SLOT; slot = (slot + 1U) & table.mask)
+        {
+        }
+        table.pkeys[slot] = key;
+        table.pidx[slot] = (uint32_t)ee;
+    }
+
+    return entries;
+}
+
+
+// checks a full key against every known byte
+static int confirm(const uint8_t key[WAU8_KEY_SZ])
+{
+    uint8_t buff[MAX_KNOWN];
+    wau8_context_t con;
+
+    wau8_set_wheels(&con, &wheels);
+    wau8_set_key(&con, (const wau8_key_t)key);
+    wau8_seek(&con, known_offset);
+    wau8_keystream(&con, buff, nknown);
+    return memcmp(buff, known, nknown) == 0;
+}
+
+
+// looks up every key for the table wheels that goes with the
+// enumerated wheel positions in ppos
+static void probe(const uint64_t partial, const uint32_t * ppos)
+{
+    const uint64_t want = (partial ^ known_word) & known_mask;
+    uint64_t slot;
+
+    for (slot = table_slot(want); table.pidx[slot] != EMPTY_SLOT; slot = (slot + 1U) & table.mask)
+    {
+        if (table.pkeys[slot] == want)
+        {
+            uint8_t key[WAU8_KEY_SZ];
+            uint64_t rest = table.pidx[slot];
+            size_t ii;
+
+            for (ii = 0; ii < nsplit; ii++)
+            {
+                key[ii] = (uint8_t)ppos[ii];
+            }
+            for (ii = nsplit; ii < WAU8_KEY_SZ; ii++)
+            {
+                key[ii] = (uint8_t)(rest % WAU8_WHEEL_SZ[ii]);
+                rest /= WAU8_WHEEL_SZ[ii];
+            }
+
+            if (confirm(key))
+            {
+#pragma omp critical
+                {
+                    if (nfound < MAX_FOUND)
+                    {
+                        memcpy(found[nfound++], key, WAU8_KEY_SZ);
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+// enumerated wheels are split into outer wheels [0, nouter) and the
+// inner ones [nouter, nsplit) (at most two, about 60000 combinations)
+// a slice is one combination of outer wheel positions and every
+// combination of inner wheels, which is one unit of parallel work
+// returns number of combinations tried
+static uint64_t search_slice(uint64_t slice)
+{
+    uint32_t pos[WAU8_KEY_SZ];
+    uint64_t partial = 0U;
+    const uint64_t * plast = pcontrib[nsplit - 1U];
+    const uint32_t last_sz = WAU8_WHEEL_SZ[nsplit - 1U];
+    size_t ii;
+
+    for (ii = 0; ii < nouter; ii++)
+    {
+        pos[ii] = (uint32_t)(slice % WAU8_WHEEL_SZ[ii]);
+        slice /= WAU8_WHEEL_SZ[ii];
+        partial ^= pcontrib[ii][pos[ii]];
+    }
+
+    if ((nsplit - nouter) == 1U)
+    {
+        uint32_t pp;
+        for (pp = 0; pp < last_sz; pp++)
+        {
+            pos[nouter] = pp;
+            probe(partial ^ plast[pp], pos);
+        }
+        return last_sz;
+    }
+    else
+    {
+        const uint64_t * pnext = pcontrib[nouter];
+        const uint32_t next_sz = WAU8_WHEEL_SZ[nouter];
+        uint32_t qq;
+        uint32_t pp;
+
+        for (qq = 0; qq < next_sz; qq++)
+        {
+            const uint64_t pq = partial ^ pnext[qq];
+            pos[nouter] = qq;
+            for (pp = 0; pp < last_sz; pp++)
+            {
+                pos[nouter + 1U] = pp;
+                probe(pq ^ plast[pp], pos);
+            }
+        }
+        return (uint64_t)next_sz * last_sz;
+    }
+}
+
+
+static int parse_hex(const char * s, uint8_t * pbuff, const size_t max_sz, size_t * psz)
+{
+    size_t len = strlen(s);
+    size_t ii;
+
+    if (((len % 2U) != 0U) || ((len / 2U) > max_sz))
+    {
+        return -1;
+    }
+
+    for (ii = 0; ii < (len / 2U); ii++)
+    {
+        char hex[3] = { s[2U * ii], s[(2U * ii) + 1U], 0 };
+        char * pend;
+        pbuff[ii] = (uint8_t)strtoul(hex, &pend, 16);
+        if (*pend != 0)
+        {
+            return -1;
+        }
+    }
+
+    *psz = len / 2U;
+    return 0;
+}
+
+
+static int load_wheels(const char * path)
+{
+    FILE * pf = fopen(path, "rb");
+    size_t n;
+
+    if (pf == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    n = fread(&wheels, 1U, sizeof(wheels), pf);
+    fclose(pf);
+    if (n != sizeof(wheels))
+    {
+        fprintf(stderr, "%s: expected %u bytes of wheel data\n",
+            path, (unsigned int)sizeof(wheels));
+        return -1;
+    }
+
+    return 0;
+}
+
+
+// xors known plaintext and ciphertext files to get known keystream
+static int load_known(const char * ppath, const char * cpath)
+{
+    uint8_t pbuff[MAX_KNOWN];
+    FILE * pfp = fopen(ppath, "rb");
+    FILE * pfc = fopen(cpath, "rb");
+    size_t np = 0U;
+    size_t nc = 0U;
+    size_t ii;
+
+    if ((pfp != NULL) && (pfc != NULL))
+    {
+        np = fread(pbuff, 1U, sizeof(pbuff), pfp);
+        nc = fread(known, 1U, sizeof(known), pfc);
+    }
+    if (pfp != NULL)
+    {
+        fclose(pfp);
+    }
+    if (pfc != NULL)
+    {
+        fclose(pfc);
+    }
+
+    nknown = (np < nc) ? np : nc;
+    for (ii = 0; ii < nknown; ii++)
+    {
+        known[ii] ^= pbuff[ii];
+    }
+
+    return (nknown > 0U) ? 0 : -1;
+}
+
+
+static void usage(void)
+{
+    fprintf(stderr,
+        "usage: wau8audit -w WHEELS|-s SEED (-p PLAIN -c CIPHER | -K HEX | -k KEY) [options]\n"
+        "  -w WHEELS   file holding a raw wau8_wheels_t (%u bytes)\n"
+        "  -s SEED     wheels made by wau8_make_wheels from a seed\n"
+        "  -p/-c FILE  known plaintext and matching ciphertext\n"
+        "  -K HEX      known keystream as hex\n"
+        "  -k KEY      make %u bytes of known keystream from this key (self test)\n"
+        "  -O OFFSET   keystream offset of the first known byte (default 0)\n"
+        "  -M MB       memory for the table (default %u)\n"
+        "  -L N        stop after about N combinations and project the rest\n"
+        "  -t THREADS  worker threads (default OpenMP default)\n",
+        (unsigned int)sizeof(wau8_wheels_t),
+        16U,
+        DEFAULT_TABLE_MB);
+}
+
+
+int main(int argc, char* argv[])
+{
+    const char * ppath = NULL;
+    const char * cpath = NULL;
+    uint8_t key[WAU8_KEY_SZ];
+    size_t key_sz = 0U;
+    int have_wheels = 0;
+    uint64_t table_mb = DEFAULT_TABLE_MB;
+    uint64_t entries;
+    uint64_t tried = 0U;
+    uint64_t total = 1U;
+    uint64_t limit = 0U;
+    uint64_t slice_sz = 1U;
+    uint64_t slices;
+    int nthreads = 0;
+    double t0;
+    double t_table;
+    double t_search;
+    double rate;
+    ptrdiff_t ss;
+    size_t ii;
+    int aa;
+
+    for (aa = 1; aa < argc; aa += 2)
+    {
+        const char * parg = ((aa + 1) < argc) ? argv[aa + 1] : NULL;
+        int bad = (parg == NULL);
+
+        if (bad)
+        {
+        }
+        else if (strcmp(argv[aa], "-w") == 0)
+        {
+            if (load_wheels(parg) != 0)
+            {
+                return 1;
+            }
+            have_wheels = 1;
+        }
+        else if (strcmp(argv[aa], "-s") == 0)
+        {
+            wau8_make_wheels(&wheels, strtoull(parg, NULL, 0));
+            have_wheels = 1;
+        }
+        else if (strcmp(argv[aa], "-p") == 0) { ppath = parg; }
+        else if (strcmp(argv[aa], "-c") == 0) { cpath = parg; }
+        else if (strcmp(argv[aa], "-K") == 0) { bad = parse_hex(parg, known, MAX_KNOWN, &nknown); }
+        else if (strcmp(argv[aa], "-k") == 0) { bad = parse_hex(parg, key, WAU8_KEY_SZ, &key_sz) || (key_sz != WAU8_KEY_SZ); }
+        else if (strcmp(argv[aa], "-O") == 0) { known_offset = strtoull(parg, NULL, 0); }
+        else if (strcmp(argv[aa], "-M") == 0) { table_mb = strtoull(parg, NULL, 0); }
+        else if (strcmp(argv[aa], "-L") == 0) { limit = strtoull(parg, NULL, 0); }
+        else if (strcmp(argv[aa], "-t") == 0) { nthreads = atoi(parg); }
+        else { bad = 1; }
+
+        if (bad)
+        {
+            usage();
+            return 2;
+        }
+    }
+
+    if (!have_wheels)
+    {
+        usage();
+        return 2;
+    }
+
+    if (key_sz != 0U)
+    {
+        wau8_context_t con;
+        wau8_set_wheels(&con, &wheels);
+        wau8_set_key(&con, (const wau8_key_t)key);
+        wau8_seek(&con, known_offset);
+        nknown = 16U;
+        wau8_keystream(&con, known, nknown);
+    }
+    else if ((ppath != NULL) && (cpath != NULL))
+    {
+        if (load_known(ppath, cpath) != 0)
+        {
+            fprintf(stderr, "no known plaintext/ciphertext\n");
+            return 1;
+        }
+    }
+
+    if (nknown == 0U)
+    {
+        usage();
+        return 2;
+    }
+
+#ifdef _OPENMP
+    if (nthreads > 0)
+    {
+        omp_set_num_threads(nthreads);
+    }
+    nthreads = omp_get_max_threads();
+#else
+    nthreads = 1;
+#endif
+
+    if (table_mb > (UINT64_MAX >> 20U))
+    {
+        table_mb = UINT64_MAX >> 20U;
+    }
+
+    // as many wheels in the table as fit in memory (12 bytes a slot,
+    // 2 to 4 slots an entry) and entry numbers fit 32 bits,
+    // but always at least one wheel enumerated
+    entries = 1U;
+    nsplit = WAU8_KEY_SZ;
+    while ((nsplit > 1U) &&
+        ((entries * WAU8_WHEEL_SZ[nsplit - 1U]) <= MAX_ENTRIES) &&
+        ((table_slots(entries * WAU8_WHEEL_SZ[nsplit - 1U]) * SLOT_BYTES) <= (table_mb << 20U)))
+    {
+        nsplit--;
+        entries *= WAU8_WHEEL_SZ[nsplit];
+    }
+    if (nsplit == WAU8_KEY_SZ)
+    {
+        fprintf(stderr, "not enough memory for any wheels in the table\n");
+        return 1;
+    }
+
+    nouter = (nsplit > 2U) ? (nsplit - 2U) : 0U;
+    for (ii = 0; ii < nsplit; ii++)
+    {
+        total *= WAU8_WHEEL_SZ[ii];
+        if (ii >= nouter)
+        {
+            slice_sz *= WAU8_WHEEL_SZ[ii];
+        }
+    }
+    slices = total / slice_sz;
+    if ((limit != 0U) && (((limit + slice_sz - 1U) / slice_sz) < slices))
+    {
+        slices = (limit + slice_sz - 1U) / slice_sz;
+    }
+
+    t0 = now();
+    if ((make_contrib() != 0) || (make_table() == 0U))
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    t_table = now() - t0;
+
+    printf("known bytes:    %u at offset %llu\n",
+        (unsigned int)nknown, (unsigned long long)known_offset);
+    printf("table wheels:   %u (%llu entries, %.2f s)\n",
+        (unsigned int)(WAU8_KEY_SZ - nsplit), (unsigned long long)entries, t_table);
+    printf("searched wheels: %u (%llu combinations, %llu of %llu searched)\n",
+        (unsigned int)nsplit, (unsigned long long)total,
+        (unsigned long long)(slices * slice_sz), (unsigned long long)total);
+
+    t0 = now();
+#pragma omp parallel for schedule(dynamic) reduction(+:tried)
+    for (ss = 0; ss < (ptrdiff_t)slices; ss++)
+    {
+        tried += search_slice((uint64_t)ss);
+    }
+    t_search = now() - t0;
+
+    rate = (t_search > 0.0) ? ((double)tried / t_search) : 0.0;
+    printf("threads:        %d\n", nthreads);
+    printf("combinations:   %llu in %.2f s, %.3g/s\n",
+        (unsigned long long)tried, t_search, rate);
+    printf("keys checked:   %.3g/s (each combination covers every table entry)\n",
+        rate * (double)entries);
+    if (rate > 0.0)
+    {
+        double secs = (double)total / rate;
+        printf("full search:    %.3g s (%.3g days)\n", secs, secs / 86400.0);
+    }
+
+    for (ii = 0; ii < nfound; ii++)
+    {
+        size_t kk;
+        printf("found key:      ");
+        for (kk = 0; kk < WAU8_KEY_SZ; kk++)
+        {
+            printf("%02x", found[ii][kk]);
+        }
+        printf("\n");
+    }
+
+    return 0;
+}
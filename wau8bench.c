@@ -0,0 +1,753 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+// throughput and latency benchmark for the wau8 core
+// reports bytes/sec, cycles/byte and time per call for each backend
+// as a text table, CSV or JSON
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "wau8.h"
+#include "wau8_batch.h"
+#include "wau8_par.h"
+#include "wau8_ring.h"
+#include "wau8w.h"
+#include "wau8_bs.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define HAVE_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC
+#endif
+
+#define MIN_MSG_SZ          (16U)
+#define DEFAULT_MAX_SZ      (256U << 20U)
+#define EVICT_SZ            (64U << 20U)
+#define COLD_MAX_SZ         (4096U)
+#define COLD_REPS           (200U)
+#define SETUP_REPS          (1000000U)
+#define MAX_RESULTS         (512U)
+#define BATCH_COUNT         (4096U)
+#define LAT_COUNT           (20000U)
+#define LAT_MAX_SZ          (1024U)
+#define RING_SZ             (1U << 16U)
+
+
+typedef enum
+{
+    FMT_TEXT = 0,
+    FMT_CSV,
+    FMT_JSON,
+} format_t;
+
+typedef void (*run_fn_t)(wau8_context_t * pcon, uint8_t * pbuff, const size_t sz);
+
+typedef struct
+{
+    const char * name;
+    run_fn_t run;
+    wau8_backend_t backend;
+    int use_ext;
+    int use_fused;
+} backend_t;
+
+typedef struct
+{
+    const char * test;
+    const char * backend;
+    const char * cache;
+    size_t sz;
+    int nthreads;
+    uint64_t reps;
+    double secs;
+    uint64_t cycles;
+} result_t;
+
+
+static wau8_wheels_t wheels;
+static wau8_ext_wheels_t xwheels;
+static wau8_fused_wheels_t fwheels;
+static wau8w_wheels_t wwheels;
+static wau8_bs_t bs;
+static wau8_par_cfg_t par_cfg;
+static result_t results[MAX_RESULTS];
+static size_t nresults = 0U;
+static double target_secs = 0.1;
+
+static const uint8_t key[WAU8_KEY_SZ] =
+{
+    0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0,
+};
+
+
+// seconds since the first call
+// (seconds since the epoch don't leave a double enough bits for nanoseconds)
+static double now(void)
+{
+    static time_t base = 0;
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    if (base == 0)
+    {
+        base = ts.tv_sec;
+    }
+    return (double)(ts.tv_sec - base) + ((double)ts.tv_nsec * 1e-9);
+}
+
+
+static uint64_t cycles(void)
+{
+#ifdef HAVE_RDTSC
+    return (uint64_t)__rdtsc();
+#else
+    return 0U;
+#endif
+}
+
+
+// one byte at a time through the single-step API
+static void run_step(wau8_context_t * pcon, uint8_t * pbuff, const size_t sz)
+{
+    size_t jj;
+    for (jj = 0; jj < sz; jj++)
+    {
+        pbuff[jj] ^= wau8_get_val(pcon);
+        wau8_advance(pcon);
+    }
+}
+
+
+static void run_bulk(wau8_context_t * pcon, uint8_t * pbuff, const size_t sz)
+{
+    wau8_xor(pcon, pbuff, pbuff, sz);
+}
+
+
+static void run_par(wau8_context_t * pcon, uint8_t * pbuff, const size_t sz)
+{
+    wau8_xor_par(pcon, pbuff, pbuff, sz, &par_cfg);
+}
+
+
+static const backend_t backends[] =
+{
+    { "step", run_step, WAU8_BACKEND_SCALAR, 0, 0 },
+    { "scalar", run_bulk, WAU8_BACKEND_SCALAR, 0, 0 },
+    { "fused", run_bulk, WAU8_BACKEND_SCALAR, 0, 1 },
+    { "sse2", run_bulk, WAU8_BACKEND_SSE2, 1, 0 },
+    { "avx2", run_bulk, WAU8_BACKEND_AVX2, 1, 0 },
+    { "avx512", run_bulk, WAU8_BACKEND_AVX512, 1, 0 },
+    { "par", run_par, WAU8_BACKEND_AUTO, 1, 0 },
+};
+
+#define NBACKENDS       (sizeof(backends) / sizeof(backends[0]))
+#define PAR_BACKEND     (&backends[NBACKENDS - 1U])
+
+
+static result_t * add_result(
+    const char * test,
+    const char * backend,
+    const char * cache,
+    const size_t sz,
+    const int nthreads)
+{
+    result_t * pr = &results[nresults];
+    if (nresults < (MAX_RESULTS - 1U))
+    {
+        nresults++;
+    }
+    memset(pr, 0, sizeof(*pr));
+    pr->test = test;
+    pr->backend = backend;
+    pr->cache = cache;
+    pr->sz = sz;
+    pr->nthreads = nthreads;
+    return pr;
+}
+
+
+static void init_context(wau8_context_t * pcon, const backend_t * pb)
+{
+    wau8_set_backend(pb->backend);
+    wau8_set_wheels(pcon, &wheels);
+    if (pb->use_ext)
+    {
+        wau8_set_ext_wheels(pcon, &xwheels);
+    }
+    if (pb->use_fused)
+    {
+        wau8_set_fused_wheels(pcon, &fwheels);
+    }
+    wau8_set_key(pcon, &key);
+}
+
+
+// repeats the run, doubling the count until it takes at least target_secs
+static void time_warm(
+    const backend_t * pb,
+    uint8_t * pbuff,
+    const size_t sz,
+    const int nthreads)
+{
+    result_t * pr = add_result("xor", pb->name, "warm", sz, nthreads);
+    wau8_context_t con;
+    uint64_t reps = 1U;
+
+    init_context(&con, pb);
+    pb->run(&con, pbuff, sz);
+
+    for (;;)
+    {
+        uint64_t ii;
+        double t0 = now();
+        uint64_t c0 = cycles();
+        for (ii = 0; ii < reps; ii++)
+        {
+            pb->run(&con, pbuff, sz);
+        }
+        pr->cycles = cycles() - c0;
+        pr->secs = now() - t0;
+        pr->reps = reps;
+        if ((pr->secs >= target_secs) || (reps >= (UINT64_MAX / 2U)))
+        {
+            break;
+        }
+        reps *= 2U;
+    }
+}
+
+
+// wide variant, 8 bytes per step of the wheels
+static void time_wide(uint8_t * pbuff, const size_t sz)
+{
+    result_t * pr = add_result("xor", "wide", "warm", sz, 1);
+    wau8w_context_t con;
+    uint64_t reps = 1U;
+
+    wau8w_set_wheels(&con, &wwheels);
+    wau8w_set_key(&con, &key);
+    wau8w_xor(&con, pbuff, pbuff, sz);
+
+    for (;;)
+    {
+        uint64_t ii;
+        double t0 = now();
+        uint64_t c0 = cycles();
+        for (ii = 0; ii < reps; ii++)
+        {
+            wau8w_xor(&con, pbuff, pbuff, sz);
+        }
+        pr->cycles = cycles() - c0;
+        pr->secs = now() - t0;
+        pr->reps = reps;
+        if ((pr->secs >= target_secs) || (reps >= (UINT64_MAX / 2U)))
+        {
+            break;
+        }
+        reps *= 2U;
+    }
+}
+
+
+// bitsliced engine, one buffer split into 64 runs
+// (counts setting up the engine, which it does on every call)
+static void time_bs(uint8_t * pbuff, const size_t sz)
+{
+    result_t * pr = add_result("xor", "bitslice", "warm", sz, 1);
+    wau8_context_t con;
+    uint64_t reps = 1U;
+
+    wau8_set_wheels(&con, &wheels);
+    wau8_set_key(&con, &key);
+    wau8_xor_bs(&bs, &con, pbuff, pbuff, sz);
+
+    for (;;)
+    {
+        uint64_t ii;
+        double t0 = now();
+        uint64_t c0 = cycles();
+        for (ii = 0; ii < reps; ii++)
+        {
+            wau8_xor_bs(&bs, &con, pbuff, pbuff, sz);
+        }
+        pr->cycles = cycles() - c0;
+        pr->secs = now() - t0;
+        pr->reps = reps;
+        if ((pr->secs >= target_secs) || (reps >= (UINT64_MAX / 2U)))
+        {
+            break;
+        }
+        reps *= 2U;
+    }
+}
+
+
+// every run starts with wheels, context and message pushed out of cache
+static void time_cold(
+    const backend_t * pb,
+    uint8_t * pbuff,
+    uint8_t * pevict,
+    const size_t sz)
+{
+    result_t * pr = add_result("xor", pb->name, "cold", sz, 1);
+    wau8_context_t con;
+    unsigned int ii;
+
+    init_context(&con, pb);
+    for (ii = 0; ii < COLD_REPS; ii++)
+    {
+        double t0;
+        uint64_t c0;
+        size_t jj;
+
+        for (jj = 0; jj < EVICT_SZ; jj += 64U)
+        {
+            pevict[jj]++;
+        }
+
+        t0 = now();
+        c0 = cycles();
+        pb->run(&con, pbuff, sz);
+        pr->cycles += cycles() - c0;
+        pr->secs += now() - t0;
+    }
+    pr->reps = COLD_REPS;
+}
+
+
+static void time_setup(void)
+{
+    static wau8_wheels_t tmp_wheels;
+    result_t * pr;
+    wau8_context_t con;
+    uint8_t k[WAU8_KEY_SZ];
+    double t0;
+    uint64_t c0;
+    unsigned int ii;
+
+    memcpy(k, key, sizeof(k));
+    wau8_set_wheels(&con, &wheels);
+
+    pr = add_result("set_key", "", "warm", 0U, 1);
+    t0 = now();
+    c0 = cycles();
+    for (ii = 0; ii < SETUP_REPS; ii++)
+    {
+        k[0] = (uint8_t)ii;
+        wau8_set_key(&con, (const wau8_key_t)&k);
+    }
+    pr->cycles = cycles() - c0;
+    pr->secs = now() - t0;
+    pr->reps = SETUP_REPS;
+
+    pr = add_result("seek", "", "warm", 0U, 1);
+    t0 = now();
+    c0 = cycles();
+    for (ii = 0; ii < SETUP_REPS; ii++)
+    {
+        wau8_seek(&con, (uint64_t)ii * 0x9E3779B97F4A7C15ULL);
+    }
+    pr->cycles = cycles() - c0;
+    pr->secs = now() - t0;
+    pr->reps = SETUP_REPS;
+
+    pr = add_result("make_wheels", "", "warm", 0U, 1);
+    t0 = now();
+    c0 = cycles();
+    for (ii = 0; ii < (SETUP_REPS / 100U); ii++)
+    {
+        wau8_make_wheels(&tmp_wheels, ii);
+    }
+    pr->cycles = cycles() - c0;
+    pr->secs = now() - t0;
+    pr->reps = SETUP_REPS / 100U;
+
+    pr = add_result("make_ext_wheels", "", "warm", 0U, 1);
+    t0 = now();
+    c0 = cycles();
+    for (ii = 0; ii < (SETUP_REPS / 100U); ii++)
+    {
+        wheels.a[0] = (uint8_t)ii;
+        wau8_make_ext_wheels(&xwheels, &wheels);
+    }
+    pr->cycles = cycles() - c0;
+    pr->secs = now() - t0;
+    pr->reps = SETUP_REPS / 100U;
+
+    pr = add_result("make_fused_wheels", "", "warm", 0U, 1);
+    t0 = now();
+    c0 = cycles();
+    for (ii = 0; ii < (SETUP_REPS / 10000U); ii++)
+    {
+        wheels.a[0] = (uint8_t)ii;
+        wau8_make_fused_wheels(&fwheels, &wheels);
+    }
+    pr->cycles = cycles() - c0;
+    pr->secs = now() - t0;
+    pr->reps = SETUP_REPS / 10000U;
+}
+
+
+// many short messages each with its own key
+// once as a loop of wau8_set_key + wau8_xor and once through wau8_xor_batch
+// the context only has plain wheels, as a caller handling records would
+static void time_batch(uint8_t * pbuff, const size_t msg_sz)
+{
+    static wau8_batch_item_t items[BATCH_COUNT];
+    result_t * pr_loop = add_result("per_msg", "auto", "warm", msg_sz, 1);
+    result_t * pr_batch = add_result("batch", "auto", "warm", msg_sz, 1);
+    wau8_context_t con;
+    uint64_t reps = 1U;
+    size_t ii;
+
+    wau8_set_backend(WAU8_BACKEND_AUTO);
+    wau8_set_wheels(&con, &wheels);
+    for (ii = 0; ii < BATCH_COUNT; ii++)
+    {
+        memcpy(items[ii].key, key, sizeof(key));
+        items[ii].key[0] = (uint8_t)ii;
+        items[ii].key[1] = (uint8_t)(ii >> 8U);
+        items[ii].psrc = pbuff + (ii * msg_sz);
+        items[ii].pdst = pbuff + (ii * msg_sz);
+        items[ii].sz = msg_sz;
+    }
+
+    for (;;)
+    {
+        uint64_t rr;
+        double t0 = now();
+        uint64_t c0 = cycles();
+        for (rr = 0; rr < reps; rr++)
+        {
+            for (ii = 0; ii < BATCH_COUNT; ii++)
+            {
+                wau8_set_key(&con, &items[ii].key);
+                wau8_xor(&con, items[ii].psrc, items[ii].pdst, items[ii].sz);
+            }
+        }
+        pr_loop->cycles = cycles() - c0;
+        pr_loop->secs = now() - t0;
+        pr_loop->reps = reps * BATCH_COUNT;
+
+        t0 = now();
+        c0 = cycles();
+        for (rr = 0; rr < reps; rr++)
+        {
+            wau8_xor_batch(&con, items, BATCH_COUNT);
+        }
+        pr_batch->cycles = cycles() - c0;
+        pr_batch->secs = now() - t0;
+        pr_batch->reps = reps * BATCH_COUNT;
+
+        if (pr_batch->secs >= target_secs)
+        {
+            break;
+        }
+        reps *= 2U;
+    }
+}
+
+
+static int cmp_double(const void * pa, const void * pb)
+{
+    double a = *(const double *)pa;
+    double b = *(const double *)pb;
+    return (a > b) - (a < b);
+}
+
+
+// adds 50th and 99th percentile rows for a set of per-message times
+// cycle counts are scaled from the cycle rate over the whole run
+static void add_latency(
+    const char * backend,
+    const size_t msg_sz,
+    double * plat,
+    const size_t count,
+    const double cyc_per_sec)
+{
+    result_t * pr;
+
+    qsort(plat, count, sizeof(plat[0]), cmp_double);
+
+    pr = add_result("lat_p50", backend, "warm", msg_sz, 1);
+    pr->reps = 1U;
+    pr->secs = plat[count / 2U];
+    pr->cycles = (uint64_t)(pr->secs * cyc_per_sec);
+
+    pr = add_result("lat_p99", backend, "warm", msg_sz, 1);
+    pr->reps = 1U;
+    pr->secs = plat[(count * 99U) / 100U];
+    pr->cycles = (uint64_t)(pr->secs * cyc_per_sec);
+}
+
+
+// per-message latency for sub-KB messages
+// once making keystream inline with wau8_xor and once from a prefetch ring
+// the ring is topped up between messages, standing in for a producer
+// that runs while the sender is idle, so only the XOR is on the clock
+static void time_latency(uint8_t * pbuff, const size_t msg_sz)
+{
+    static double lat[LAT_COUNT];
+    static uint8_t ring_buff[RING_SZ];
+    wau8_ring_t ring;
+    wau8_context_t con;
+    double t_run;
+    uint64_t c_run;
+    size_t ii;
+
+    init_context(&con, PAR_BACKEND);
+    t_run = now();
+    c_run = cycles();
+    for (ii = 0; ii < LAT_COUNT; ii++)
+    {
+        double t0 = now();
+        wau8_xor(&con, pbuff, pbuff, msg_sz);
+        lat[ii] = now() - t0;
+    }
+    c_run = cycles() - c_run;
+    t_run = now() - t_run;
+    add_latency("inline", msg_sz, lat, LAT_COUNT, (double)c_run / t_run);
+
+    init_context(&con, PAR_BACKEND);
+    wau8_ring_init(&ring, &con, ring_buff, RING_SZ, RING_SZ / 4U, (RING_SZ * 3U) / 4U);
+    t_run = now();
+    c_run = cycles();
+    for (ii = 0; ii < LAT_COUNT; ii++)
+    {
+        double t0;
+        wau8_ring_fill(&ring);
+        t0 = now();
+        wau8_ring_xor(&ring, pbuff, pbuff, msg_sz);
+        lat[ii] = now() - t0;
+    }
+    c_run = cycles() - c_run;
+    t_run = now() - t_run;
+    add_latency("ring", msg_sz, lat, LAT_COUNT, (double)c_run / t_run);
+}
+
+
+static void print_results(const format_t fmt)
+{
+    size_t ii;
+
+    if (fmt == FMT_TEXT)
+    {
+        printf("%-18s %-8s %-5s %12s %4s %12s %10s %12s\n",
+            "test", "backend", "cache", "bytes", "thr", "MB/s", "cyc/byte", "ns/call");
+    }
+    else if (fmt == FMT_CSV)
+    {
+        printf("test,backend,cache,bytes,threads,reps,secs,bytes_per_sec,cycles_per_byte,ns_per_call\n");
+    }
+    else
+    {
+        printf("[\n");
+    }
+
+    for (ii = 0; ii < nresults; ii++)
+    {
+        const result_t * pr = &results[ii];
+        double total = (double)pr->sz * (double)pr->reps;
+        double bps = (pr->secs > 0.0) ? (total / pr->secs) : 0.0;
+        double cpb = (total > 0.0) ? ((double)pr->cycles / total) : 0.0;
+        double nspc = (pr->reps > 0U) ? ((pr->secs * 1e9) / (double)pr->reps) : 0.0;
+
+        if (fmt == FMT_TEXT)
+        {
+            printf("%-18s %-8s %-5s %12zu %4d %12.1f %10.3f %12.1f\n",
+                pr->test, pr->backend, pr->cache, pr->sz, pr->nthreads,
+                bps / 1e6, cpb, nspc);
+        }
+        else if (fmt == FMT_CSV)
+        {
+            printf("%s,%s,%s,%zu,%d,%llu,%.6f,%.1f,%.4f,%.1f\n",
+                pr->test, pr->backend, pr->cache, pr->sz, pr->nthreads,
+                (unsigned long long)pr->reps, pr->secs, bps, cpb, nspc);
+        }
+        else
+        {
+            printf("  {\"test\": \"%s\", \"backend\": \"%s\", \"cache\": \"%s\", "
+                "\"bytes\": %zu, \"threads\": %d, \"reps\": %llu, \"secs\": %.6f, "
+                "\"bytes_per_sec\": %.1f, \"cycles_per_byte\": %.4f, \"ns_per_call\": %.1f}%s\n",
+                pr->test, pr->backend, pr->cache, pr->sz, pr->nthreads,
+                (unsigned long long)pr->reps, pr->secs, bps, cpb, nspc,
+                (ii + 1U < nresults) ? "," : "");
+        }
+    }
+
+    if (fmt == FMT_JSON)
+    {
+        printf("]\n");
+    }
+}
+
+
+static void usage(void)
+{
+    fprintf(stderr,
+        "usage: wau8bench [-f text|csv|json] [-m MAXBYTES] [-t MAXTHREADS] [-s SECS]\n");
+}
+
+
+int main(int argc, char* argv[])
+{
+    format_t fmt = FMT_TEXT;
+    size_t max_sz = DEFAULT_MAX_SZ;
+    int max_threads = 1;
+    uint8_t * pbuff;
+    uint8_t * pevict;
+    size_t sz;
+    size_t ii;
+    int nn;
+
+#ifdef _OPENMP
+    max_threads = omp_get_max_threads();
+#endif
+
+    for (nn = 1; nn < argc; nn++)
+    {
+        const char * arg = argv[nn];
+        const char * val = (nn + 1 < argc) ? argv[nn + 1] : NULL;
+
+        if ((strcmp(arg, "-f") == 0) && (val != NULL))
+        {
+            fmt = (strcmp(val, "csv") == 0) ? FMT_CSV :
+                (strcmp(val, "json") == 0) ? FMT_JSON : FMT_TEXT;
+            nn++;
+        }
+        else if ((strcmp(arg, "-m") == 0) && (val != NULL))
+        {
+            max_sz = (size_t)strtoull(val, NULL, 0);
+            nn++;
+        }
+        else if ((strcmp(arg, "-t") == 0) && (val != NULL))
+        {
+            max_threads = atoi(val);
+            nn++;
+        }
+        else if ((strcmp(arg, "-s") == 0) && (val != NULL))
+        {
+            target_secs = atof(val);
+            nn++;
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+
+    if (max_sz < MIN_MSG_SZ)
+    {
+        max_sz = MIN_MSG_SZ;
+    }
+    if (max_threads < 1)
+    {
+        max_threads = 1;
+    }
+
+    wau8_make_wheels(&wheels, 1U);
+    pbuff = (uint8_t *)malloc(max_sz);
+    pevict = (uint8_t *)malloc(EVICT_SZ);
+    if ((pbuff == NULL) || (pevict == NULL))
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    memset(pbuff, 0, max_sz);
+    memset(pevict, 0, EVICT_SZ);
+
+    // setup timing scribbles on the wheels so the tables get built after it
+    time_setup();
+    wau8_make_ext_wheels(&xwheels, &wheels);
+    wau8_make_fused_wheels(&fwheels, &wheels);
+    wau8w_make_wheels(&wwheels, 1U);
+
+    // message sizes go up by 4x from 16 bytes to the max
+    wau8_par_init_cfg(&par_cfg);
+    par_cfg.nthreads = max_threads;
+    for (ii = 0; ii < NBACKENDS; ii++)
+    {
+        if (!wau8_backend_available(backends[ii].backend))
+        {
+            continue;
+        }
+        for (sz = MIN_MSG_SZ; sz <= max_sz; sz *= 4U)
+        {
+            time_warm(&backends[ii], pbuff, sz, (backends[ii].run == run_par) ? max_threads : 1);
+        }
+    }
+
+    for (sz = MIN_MSG_SZ; sz <= max_sz; sz *= 4U)
+    {
+        time_wide(pbuff, sz);
+        time_bs(pbuff, sz);
+    }
+
+    for (ii = 0; ii < NBACKENDS; ii++)
+    {
+        if ((backends[ii].run == run_par) || !wau8_backend_available(backends[ii].backend))
+        {
+            continue;
+        }
+        for (sz = MIN_MSG_SZ; sz <= COLD_MAX_SZ; sz *= 4U)
+        {
+            time_cold(&backends[ii], pbuff, pevict, sz);
+        }
+    }
+
+    for (sz = 64U; (sz <= 512U) && ((sz * BATCH_COUNT) <= max_sz); sz *= 2U)
+    {
+        time_batch(pbuff, sz);
+    }
+
+    for (sz = 64U; (sz <= LAT_MAX_SZ) && (sz <= max_sz); sz *= 4U)
+    {
+        time_latency(pbuff, sz);
+    }
+
+    // thread scaling on the largest message
+    for (nn = 1; nn <= max_threads; nn *= 2)
+    {
+        par_cfg.nthreads = nn;
+        time_warm(PAR_BACKEND, pbuff, max_sz, nn);
+    }
+
+    print_results(fmt);
+
+    free(pevict);
+    free(pbuff);
+    return 0;
+}
@@ -0,0 +1,754 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+// command-line tool for encrypting/decrypting files and streams
+// regular files are memory-mapped, anything else (pipes, terminals, sockets)
+// goes through a three-stage read/XOR/write pipeline
+// POSIX only
+
+#define _FILE_OFFSET_BITS 64
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "wau8.h"
+#include "wau8_par.h"
+#include "wau8_perf.h"
+#include "wau8_session.h"
+
+#define DEFAULT_BUFF_SZ     (4U << 20U)
+#define MAP_WINDOW_SZ       (64U << 20U)
+#define BUFF_ALIGN          (4096U)
+#define PIPE_SLOTS          (3U)
+
+
+typedef enum
+{
+    SLOT_EMPTY = 0,
+    SLOT_READ,
+    SLOT_DONE,
+} slot_state_t;
+
+typedef struct
+{
+    uint8_t * pbuff;
+    size_t len;
+    slot_state_t state;
+} slot_t;
+
+typedef struct
+{
+    int ifd;
+    int ofd;
+    size_t buff_sz;
+    int err;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    slot_t slots[PIPE_SLOTS];
+} pipeline_t;
+
+
+static wau8_wheels_t wheels;
+static wau8_ext_wheels_t xwheels;
+
+
+static void usage(void)
+{
+    fprintf(stderr,
+        "usage: wau8crypt -k KEY|-R STATE -w WHEELS|-s SEED [options]\n"
+        "  -k KEY      key as 16 hex digits\n"
+        "  -R STATE    resume from a session file instead of -k and -O\n"
+        "  -S STATE    save a session file for the end of this run (mode 0600)\n"
+        "  -w WHEELS   file holding a raw wau8_wheels_t (%u bytes)\n"
+        "  -s SEED     make wheels from a seed with wau8_make_wheels instead\n"
+        "  -i FILE     input file (default stdin)\n"
+        "  -o FILE     output file (default stdout)\n"
+        "  -O OFFSET   keystream offset of first input byte (default 0)\n"
+        "  -b BYTES    pipeline buffer size (default %u)\n"
+        "  -t THREADS  worker threads (default OpenMP default)\n"
+        "  -v          report keystream counters on stderr (needs WAU8_PERF)\n",
+        (unsigned int)sizeof(wau8_wheels_t),
+        DEFAULT_BUFF_SZ);
+}
+
+
+// prints the library's global counters
+// keystream cycles are estimated from the timed sample of calls
+static void print_perf(void)
+{
+    wau8_perf_t perf;
+    double cpb;
+    unsigned int ii;
+
+    if (!wau8_perf_enabled())
+    {
+        fprintf(stderr, "wau8crypt: built without WAU8_PERF, no counters\n");
+        return;
+    }
+
+    wau8_perf_get_global(&perf);
+    cpb = wau8_perf_cycles_per_byte(&perf);
+    fprintf(stderr, "calls:       %llu\n", (unsigned long long)perf.calls);
+    fprintf(stderr, "bytes:       %llu\n", (unsigned long long)perf.bytes);
+    for (ii = WAU8_BACKEND_SCALAR; ii < WAU8_PERF_BACKENDS; ii++)
+    {
+        if (perf.backend_bytes[ii] != 0U)
+        {
+            fprintf(stderr, "  %-10s %llu\n",
+                wau8_backend_name((wau8_backend_t)ii),
+                (unsigned long long)perf.backend_bytes[ii]);
+        }
+    }
+    fprintf(stderr, "cycles/byte: %.3f (%llu calls timed)\n",
+        cpb, (unsigned long long)perf.samples);
+    fprintf(stderr, "keystream:   %.3g cycles\n", cpb * (double)perf.bytes);
+    for (ii = 0; ii < WAU8_PERF_BUCKETS; ii++)
+    {
+        if (perf.hist[ii] != 0U)
+        {
+            fprintf(stderr, "  >= %-8g %llu\n",
+                wau8_perf_bucket_floor(ii), (unsigned long long)perf.hist[ii]);
+        }
+    }
+}
+
+
+static int parse_key(const char * s, uint8_t key[WAU8_KEY_SZ])
+{
+    unsigned int ii;
+
+    if (strlen(s) != (2U * WAU8_KEY_SZ))
+    {
+        return -1;
+    }
+
+    for (ii = 0; ii < WAU8_KEY_SZ; ii++)
+    {
+        char hex[3] = { s[2U * ii], s[(2U * ii) + 1U], 0 };
+        char * pend;
+        key[ii] = (uint8_t)strtoul(hex, &pend, 16);
+        if (*pend != 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+static int load_wheels(const char * path)
+{
+    FILE * pf = fopen(path, "rb");
+    size_t n;
+
+    if (pf == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    n = fread(&wheels, 1U, sizeof(wheels), pf);
+    fclose(pf);
+    if (n != sizeof(wheels))
+    {
+        fprintf(stderr, "%s: expected %u bytes of wheel data\n",
+            path, (unsigned int)sizeof(wheels));
+        return -1;
+    }
+
+    return 0;
+}
+
+
+static int write_all(int fd, const uint8_t * p, size_t len)
+{
+    while (len > 0U)
+    {
+        ssize_t n = write(fd, p, len);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+
+// reads until buffer is full or end of input
+static ssize_t read_full(int fd, uint8_t * p, const size_t len)
+{
+    size_t got = 0U;
+    while (got < len)
+    {
+        ssize_t n = read(fd, p + got, len - got);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0)
+        {
+            break;
+        }
+        got += (size_t)n;
+    }
+    return (ssize_t)got;
+}
+
+
+// waits for a slot to reach a state, returns the pipeline's error (0 if none)
+static int slot_wait(pipeline_t * pp, slot_t * ps, const slot_state_t state)
+{
+    int err;
+
+    pthread_mutex_lock(&pp->lock);
+    while ((ps->state != state) && (pp->err == 0))
+    {
+        pthread_cond_wait(&pp->cond, &pp->lock);
+    }
+    err = pp->err;
+    pthread_mutex_unlock(&pp->lock);
+    return err;
+}
+
+
+static void slot_set(pipeline_t * pp, slot_t * ps, const slot_state_t state)
+{
+    pthread_mutex_lock(&pp->lock);
+    ps->state = state;
+    pthread_cond_broadcast(&pp->cond);
+    pthread_mutex_unlock(&pp->lock);
+}
+
+
+static void pipeline_fail(pipeline_t * pp, const char * what)
+{
+    pthread_mutex_lock(&pp->lock);
+    if (pp->err == 0)
+    {
+        pp->err = errno ? errno : EIO;
+        perror(what);
+    }
+    pthread_cond_broadcast(&pp->cond);
+    pthread_mutex_unlock(&pp->lock);
+}
+
+
+// fills slots in order, a zero-length slot marks end of input
+static void * reader_main(void * parg)
+{
+    pipeline_t * pp = (pipeline_t *)parg;
+    unsigned int ii = 0U;
+
+    for (;;)
+    {
+        slot_t * ps = &pp->slots[ii];
+        ssize_t n;
+
+        if (slot_wait(pp, ps, SLOT_EMPTY) != 0)
+        {
+            break;
+        }
+
+        n = read_full(pp->ifd, ps->pbuff, pp->buff_sz);
+        if (n < 0)
+        {
+            pipeline_fail(pp, "read");
+            break;
+        }
+
+        ps->len = (size_t)n;
+        slot_set(pp, ps, SLOT_READ);
+        if (n == 0)
+        {
+            break;
+        }
+        ii = (ii + 1U) % PIPE_SLOTS;
+    }
+
+    return NULL;
+}
+
+
+static void * writer_main(void * parg)
+{
+    pipeline_t * pp = (pipeline_t *)parg;
+    unsigned int ii = 0U;
+
+    for (;;)
+    {
+        slot_t * ps = &pp->slots[ii];
+
+        if ((slot_wait(pp, ps, SLOT_DONE) != 0) || (ps->len == 0U))
+        {
+            break;
+        }
+
+        if (write_all(pp->ofd, ps->pbuff, ps->len) != 0)
+        {
+            pipeline_fail(pp, "write");
+            break;
+        }
+
+        slot_set(pp, ps, SLOT_EMPTY);
+        ii = (ii + 1U) % PIPE_SLOTS;
+    }
+
+    return NULL;
+}
+
+
+// reading, XOR and writing each run on their own thread
+// so all three overlap across the slots
+static int run_pipeline(
+    wau8_context_t * pcon,
+    const int ifd,
+    const int ofd,
+    const size_t buff_sz,
+    const wau8_par_cfg_t * pcfg)
+{
+    pipeline_t pipe_state;
+    pthread_t reader;
+    pthread_t writer;
+    unsigned int ii;
+    int result = 0;
+
+    memset(&pipe_state, 0, sizeof(pipe_state));
+    pipe_state.ifd = ifd;
+    pipe_state.ofd = ofd;
+    pipe_state.buff_sz = buff_sz;
+    pthread_mutex_init(&pipe_state.lock, NULL);
+    pthread_cond_init(&pipe_state.cond, NULL);
+
+    for (ii = 0; ii < PIPE_SLOTS; ii++)
+    {
+        void * p = NULL;
+        if (posix_memalign(&p, BUFF_ALIGN, buff_sz) != 0)
+        {
+            fprintf(stderr, "out of memory\n");
+            result = -1;
+            break;
+        }
+        pipe_state.slots[ii].pbuff = (uint8_t *)p;
+    }
+
+    if (result == 0)
+    {
+        pthread_create(&reader, NULL, reader_main, &pipe_state);
+        pthread_create(&writer, NULL, writer_main, &pipe_state);
+
+        ii = 0U;
+        for (;;)
+        {
+            slot_t * ps = &pipe_state.slots[ii];
+            size_t len;
+
+            if (slot_wait(&pipe_state, ps, SLOT_READ) != 0)
+            {
+                break;
+            }
+
+            // the slot belongs to the writer once it is done
+            len = ps->len;
+            wau8_xor_par(pcon, ps->pbuff, ps->pbuff, len, pcfg);
+            slot_set(&pipe_state, ps, SLOT_DONE);
+            if (len == 0U)
+            {
+                break;
+            }
+            ii = (ii + 1U) % PIPE_SLOTS;
+        }
+
+        pthread_join(reader, NULL);
+        pthread_join(writer, NULL);
+        pthread_mutex_lock(&pipe_state.lock);
+        result = (pipe_state.err == 0) ? 0 : -1;
+        pthread_mutex_unlock(&pipe_state.lock);
+    }
+
+    for (ii = 0; ii < PIPE_SLOTS; ii++)
+    {
+        free(pipe_state.slots[ii].pbuff);
+    }
+    pthread_cond_destroy(&pipe_state.cond);
+    pthread_mutex_destroy(&pipe_state.lock);
+    return result;
+}
+
+
+// both sides are regular files so both get mapped
+// and the XOR goes straight from one mapping to the other
+// pages behind the current window are dropped as it moves along
+static int run_mapped(
+    wau8_context_t * pcon,
+    const int ifd,
+    const int ofd,
+    const size_t sz,
+    const wau8_par_cfg_t * pcfg)
+{
+    uint8_t * pin;
+    uint8_t * pout;
+    size_t done;
+
+    if (ftruncate(ofd, (off_t)sz) != 0)
+    {
+        perror("ftruncate");
+        return -1;
+    }
+
+    if (sz == 0U)
+    {
+        return 0;
+    }
+
+    pin = (uint8_t *)mmap(NULL, sz, PROT_READ, MAP_SHARED, ifd, 0);
+    if (pin == MAP_FAILED)
+    {
+        perror("mmap input");
+        return -1;
+    }
+
+    pout = (uint8_t *)mmap(NULL, sz, PROT_READ | PROT_WRITE, MAP_SHARED, ofd, 0);
+    if (pout == MAP_FAILED)
+    {
+        perror("mmap output");
+        munmap(pin, sz);
+        return -1;
+    }
+
+    madvise(pin, sz, MADV_SEQUENTIAL);
+    madvise(pout, sz, MADV_SEQUENTIAL);
+
+    for (done = 0U; done < sz; done += MAP_WINDOW_SZ)
+    {
+        size_t len = ((sz - done) < MAP_WINDOW_SZ) ? (sz - done) : MAP_WINDOW_SZ;
+        wau8_xor_par(pcon, pin + done, pout + done, len, pcfg);
+        madvise(pin + done, len, MADV_DONTNEED);
+    }
+
+    munmap(pout, sz);
+    munmap(pin, sz);
+    return 0;
+}
+
+
+// input is a regular file but output is not
+// mapped input is XORed into a buffer that then gets written
+static int run_mapped_in(
+    wau8_context_t * pcon,
+    const int ifd,
+    const int ofd,
+    const size_t sz,
+    const size_t buff_sz,
+    const wau8_par_cfg_t * pcfg)
+{
+    uint8_t * pin;
+    void * pbuff = NULL;
+    size_t done;
+    int result = 0;
+
+    if (sz == 0U)
+    {
+        return 0;
+    }
+
+    pin = (uint8_t *)mmap(NULL, sz, PROT_READ, MAP_SHARED, ifd, 0);
+    if (pin == MAP_FAILED)
+    {
+        perror("mmap input");
+        return -1;
+    }
+    madvise(pin, sz, MADV_SEQUENTIAL);
+
+    if (posix_memalign(&pbuff, BUFF_ALIGN, buff_sz) != 0)
+    {
+        fprintf(stderr, "out of memory\n");
+        munmap(pin, sz);
+        return -1;
+    }
+
+    for (done = 0U; done < sz; done += buff_sz)
+    {
+        size_t len = ((sz - done) < buff_sz) ? (sz - done) : buff_sz;
+        wau8_xor_par(pcon, pin + done, (uint8_t *)pbuff, len, pcfg);
+        if (write_all(ofd, (const uint8_t *)pbuff, len) != 0)
+        {
+            perror("write");
+            result = -1;
+            break;
+        }
+        madvise(pin + done, len, MADV_DONTNEED);
+    }
+
+    free(pbuff);
+    munmap(pin, sz);
+    return result;
+}
+
+
+static int load_session(const char * path, wau8_context_t * pcon)
+{
+    uint8_t buff[WAU8_SESSION_SZ];
+    FILE * pf = fopen(path, "rb");
+    size_t n;
+
+    if (pf == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    n = fread(buff, 1U, sizeof(buff), pf);
+    fclose(pf);
+
+    switch (wau8_session_load(pcon, buff, n))
+    {
+    case WAU8_SESSION_OK:
+        return 0;
+    case WAU8_SESSION_WRONG_WHEELS:
+        fprintf(stderr, "%s: session was saved with different wheels\n", path);
+        return -1;
+    default:
+        fprintf(stderr, "%s: not a session file\n", path);
+        return -1;
+    }
+}
+
+
+// the session holds the key so only the owner gets to read it
+// (an existing file is made private too before the key goes in)
+static int save_session(const char * path, const wau8_context_t * pcon)
+{
+    uint8_t buff[WAU8_SESSION_SZ];
+    size_t n = wau8_session_save(pcon, buff, sizeof(buff));
+    FILE * pf = NULL;
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+
+    if ((fd < 0) || (fchmod(fd, 0600) != 0) || ((pf = fdopen(fd, "wb")) == NULL))
+    {
+        perror(path);
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return -1;
+    }
+
+    if (fwrite(buff, 1U, n, pf) != n)
+    {
+        perror(path);
+        fclose(pf);
+        return -1;
+    }
+
+    if (fclose(pf) != 0)
+    {
+        perror(path);
+        return -1;
+    }
+
+    return 0;
+}
+
+
+int main(int argc, char* argv[])
+{
+    const char * ipath = NULL;
+    const char * opath = NULL;
+    const char * wpath = NULL;
+    const char * seed_str = NULL;
+    const char * kstr = NULL;
+    const char * rpath = NULL;
+    const char * spath = NULL;
+    uint64_t offset = 0U;
+    int offset_set = 0;
+    size_t buff_sz = DEFAULT_BUFF_SZ;
+    uint8_t key[WAU8_KEY_SZ];
+    wau8_par_cfg_t cfg;
+    wau8_context_t con;
+    struct stat ist;
+    struct stat ost;
+    int ifd = STDIN_FILENO;
+    int ofd = STDOUT_FILENO;
+    int verbose = 0;
+    int opt;
+    int result;
+
+    wau8_par_init_cfg(&cfg);
+
+    while ((opt = getopt(argc, argv, "k:w:s:i:o:O:b:t:R:S:vh")) != -1)
+    {
+        switch (opt)
+        {
+        case 'k': kstr = optarg; break;
+        case 'w': wpath = optarg; break;
+        case 's': seed_str = optarg; break;
+        case 'i': ipath = optarg; break;
+        case 'o': opath = optarg; break;
+        case 'O': offset = strtoull(optarg, NULL, 0); offset_set = 1; break;
+        case 'b': buff_sz = (size_t)strtoull(optarg, NULL, 0); break;
+        case 't': cfg.nthreads = atoi(optarg); break;
+        case 'R': rpath = optarg; break;
+        case 'S': spath = optarg; break;
+        case 'v': verbose = 1; break;
+        default: usage(); return 2;
+        }
+    }
+
+    // a session carries its own offset so -O can't go with -R
+    if (((kstr == NULL) == (rpath == NULL)) ||
+        ((rpath != NULL) && offset_set) ||
+        ((wpath == NULL) == (seed_str == NULL)) ||
+        (buff_sz == 0U))
+    {
+        usage();
+        return 2;
+    }
+
+    if ((kstr != NULL) && (parse_key(kstr, key) != 0))
+    {
+        fprintf(stderr, "key must be %u hex digits\n", 2U * WAU8_KEY_SZ);
+        return 2;
+    }
+
+    if (seed_str != NULL)
+    {
+        wau8_make_wheels(&wheels, strtoull(seed_str, NULL, 0));
+    }
+    else if (load_wheels(wpath) != 0)
+    {
+        return 1;
+    }
+
+    wau8_make_ext_wheels(&xwheels, &wheels);
+    wau8_set_wheels(&con, &wheels);
+    wau8_set_ext_wheels(&con, &xwheels);
+    if (rpath != NULL)
+    {
+        if (load_session(rpath, &con) != 0)
+        {
+            return 1;
+        }
+    }
+    else
+    {
+        wau8_set_key(&con, &key);
+        wau8_seek(&con, offset);
+    }
+
+    if ((ipath != NULL) && (strcmp(ipath, "-") != 0))
+    {
+        ifd = open(ipath, O_RDONLY);
+        if (ifd < 0)
+        {
+            perror(ipath);
+            return 1;
+        }
+    }
+
+    if ((opath != NULL) && (strcmp(opath, "-") != 0))
+    {
+        // read-write so the output can be mapped
+        // and not truncated until it's known not to be the input
+        ofd = open(opath, O_RDWR | O_CREAT, 0644);
+        if (ofd < 0)
+        {
+            perror(opath);
+            return 1;
+        }
+    }
+
+    if ((fstat(ifd, &ist) != 0) || (fstat(ofd, &ost) != 0))
+    {
+        perror("fstat");
+        return 1;
+    }
+
+    if ((ist.st_dev == ost.st_dev) && (ist.st_ino == ost.st_ino) && S_ISREG(ost.st_mode))
+    {
+        fprintf(stderr, "wau8crypt: input and output are the same file\n");
+        return 1;
+    }
+
+    if ((ofd != STDOUT_FILENO) && S_ISREG(ost.st_mode) && (ftruncate(ofd, 0) != 0))
+    {
+        perror(opath);
+        return 1;
+    }
+
+    if (S_ISREG(ist.st_mode))
+    {
+        posix_fadvise(ifd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        if (S_ISREG(ost.st_mode) && (ofd != STDOUT_FILENO))
+        {
+            result = run_mapped(&con, ifd, ofd, (size_t)ist.st_size, &cfg);
+        }
+        else
+        {
+            result = run_mapped_in(&con, ifd, ofd, (size_t)ist.st_size, buff_sz, &cfg);
+        }
+    }
+    else
+    {
+        result = run_pipeline(&con, ifd, ofd, buff_sz, &cfg);
+    }
+
+    if ((ofd != STDOUT_FILENO) && (close(ofd) != 0))
+    {
+        perror("close");
+        result = -1;
+    }
+
+    if ((result == 0) && (spath != NULL))
+    {
+        result = save_session(spath, &con);
+    }
+
+    if (verbose)
+    {
+        print_perf();
+    }
+
+    return (result == 0) ? 0 : 1;
+}
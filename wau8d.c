@@ -0,0 +1,873 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+// local encryption service
+// serves the requests in wau8d_proto.h on a Unix domain socket so that
+// processes on one machine can share one copy of the wheel tables
+// one thread runs an epoll loop over all connections, every request that
+// has arrived on a connection is handled before its replies go out in
+// one send, and stream contexts come from a fixed pool of sessions
+// Linux only
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "wau8.h"
+#include "wau8d_proto.h"
+
+#define DEFAULT_SESSIONS    (4096U)
+#define MAX_EVENTS          (64)
+
+// input buffers start small and grow to fit the biggest request seen
+#define IN_START_SZ         (64U << 10U)
+
+// a connection isn't read from while it has this much output waiting
+#define OUT_HIGH_WATER      (4U << 20U)
+
+#define NO_SESSION          (0xFFFFFFFFU)
+
+
+// one stream's context
+// sessions are chained through next in their hash bucket when in use
+// and in the free list when not
+typedef struct
+{
+    wau8_context_t con;
+    uint64_t owner;
+    uint32_t stream;
+    uint32_t next;
+} session_t;
+
+typedef struct
+{
+    int fd;
+    uint64_t id;
+    uint8_t * pin;
+    size_t in_sz;
+    size_t in_len;
+    uint8_t * pout;
+    size_t out_sz;
+    size_t out_len;
+    size_t out_sent;
+    uint8_t * pshm;
+    size_t shm_sz;
+    int pending_fd;         // memfd received ahead of its map request
+    unsigned int nsessions;
+    uint32_t events;        // events registered with epoll
+    int closing;            // close once the output has gone
+} conn_t;
+
+typedef struct
+{
+    uint64_t conns;
+    uint64_t requests;
+    uint64_t bytes;
+    uint64_t batches;
+} totals_t;
+
+
+static wau8_wheels_t wheels;
+static wau8_ext_wheels_t xwheels;
+static wau8_fused_wheels_t fwheels;
+
+static session_t * psessions;
+static uint32_t * pbuckets;
+static uint32_t bucket_mask;
+static uint32_t free_head;
+
+static int epfd = -1;
+static uint64_t next_conn_id = 1U;
+static totals_t totals;
+static volatile sig_atomic_t stop = 0;
+
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    stop = 1;
+}
+
+
+static int load_wheels(const char * path)
+{
+    FILE * pf = fopen(path, "rb");
+    size_t n;
+
+    if (pf == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    n = fread(&wheels, 1U, sizeof(wheels), pf);
+    fclose(pf);
+    if (n != sizeof(wheels))
+    {
+        fprintf(stderr, "%s: expected %u bytes of wheel data\n",
+            path, (unsigned int)sizeof(wheels));
+        return -1;
+    }
+
+    return 0;
+}
+
+
+// sets up the session pool with every session on the free list
+static int pool_init(const uint32_t count)
+{
+    uint32_t nbuckets = 1U;
+    uint32_t ii;
+
+    while (nbuckets < (2U * count))
+    {
+        nbuckets <<= 1U;
+    }
+
+    psessions = (session_t *)malloc(count * sizeof(session_t));
+    pbuckets = (uint32_t *)malloc(nbuckets * sizeof(uint32_t));
+    if ((psessions == NULL) || (pbuckets == NULL))
+    {
+        return -1;
+    }
+
+    for (ii = 0; ii < nbuckets; ii++)
+    {
+        pbuckets[ii] = NO_SESSION;
+    }
+    for (ii = 0; ii < count; ii++)
+    {
+        wau8_set_wheels(&psessions[ii].con, &wheels);
+        wau8_set_ext_wheels(&psessions[ii].con, &xwheels);
+        wau8_set_fused_wheels(&psessions[ii].con, &fwheels);
+        psessions[ii].next = ((ii + 1U) < count) ? (ii + 1U) : NO_SESSION;
+    }
+    bucket_mask = nbuckets - 1U;
+    free_head = 0U;
+    return 0;
+}
+
+
+static uint32_t pool_bucket(const uint64_t owner, const uint32_t stream)
+{
+    uint64_t h = ((owner << 32U) | stream) * 0x9E3779B97F4A7C15ULL;
+    return (uint32_t)(h >> 32U) & bucket_mask;
+}
+
+
+static session_t * pool_find(const uint64_t owner, const uint32_t stream)
+{
+    uint32_t ix = pbuckets[pool_bucket(owner, stream)];
+
+    while (ix != NO_SESSION)
+    {
+        session_t * ps = &psessions[ix];
+        if ((ps->owner == owner) && (ps->stream == stream))
+        {
+            return ps;
+        }
+        ix = ps->next;
+    }
+    return NULL;
+}
+
+
+// returns the stream's session, taking one from the free list if it has none
+static session_t * pool_get(conn_t * pconn, const uint32_t stream)
+{
+    session_t * ps = pool_find(pconn->id, stream);
+    uint32_t bucket;
+
+    if ((ps != NULL) || (free_head == NO_SESSION))
+    {
+        return ps;
+    }
+
+    ps = &psessions[free_head];
+    free_head = ps->next;
+    bucket = pool_bucket(pconn->id, stream);
+    ps->owner = pconn->id;
+    ps->stream = stream;
+    ps->next = pbuckets[bucket];
+    pbuckets[bucket] = (uint32_t)(ps - psessions);
+    pconn->nsessions++;
+    return ps;
+}
+
+
+static void pool_put(conn_t * pconn, session_t * ps)
+{
+    uint32_t * plink = &pbuckets[pool_bucket(ps->owner, ps->stream)];
+    uint32_t ix = (uint32_t)(ps - psessions);
+
+    while (*plink != ix)
+    {
+        plink = &psessions[*plink].next;
+    }
+    *plink = ps->next;
+    ps->next = free_head;
+    free_head = ix;
+    pconn->nsessions--;
+}
+
+
+// returns all of a connection's sessions to the pool
+static void pool_put_all(conn_t * pconn)
+{
+    uint32_t bb;
+
+    for (bb = 0; (bb <= bucket_mask) && (pconn->nsessions > 0U); bb++)
+    {
+        uint32_t ix = pbuckets[bb];
+        while (ix != NO_SESSION)
+        {
+            uint32_t next = psessions[ix].next;
+            if (psessions[ix].owner == pconn->id)
+            {
+                pool_put(pconn, &psessions[ix]);
+            }
+            ix = next;
+        }
+    }
+}
+
+
+static int set_events(conn_t * pconn, const uint32_t events)
+{
+    struct epoll_event ev;
+
+    if (events == pconn->events)
+    {
+        return 0;
+    }
+    ev.events = events;
+    ev.data.ptr = pconn;
+    pconn->events = events;
+    return epoll_ctl(epfd, EPOLL_CTL_MOD, pconn->fd, &ev);
+}
+
+
+static void conn_close(conn_t * pconn)
+{
+    pool_put_all(pconn);
+    epoll_ctl(epfd, EPOLL_CTL_DEL, pconn->fd, NULL);
+    close(pconn->fd);
+    if (pconn->pending_fd >= 0)
+    {
+        close(pconn->pending_fd);
+    }
+    if (pconn->pshm != NULL)
+    {
+        munmap(pconn->pshm, pconn->shm_sz);
+    }
+    free(pconn->pin);
+    free(pconn->pout);
+    free(pconn);
+}
+
+
+// makes room for sz more bytes of output, returns pointer to them
+static uint8_t * out_reserve(conn_t * pconn, const size_t sz)
+{
+    if ((pconn->out_len + sz) > pconn->out_sz)
+    {
+        size_t new_sz = (pconn->out_sz == 0U) ? IN_START_SZ : pconn->out_sz;
+        uint8_t * p;
+
+        while (new_sz < (pconn->out_len + sz))
+        {
+            new_sz *= 2U;
+        }
+        p = (uint8_t *)realloc(pconn->pout, new_sz);
+        if (p == NULL)
+        {
+            return NULL;
+        }
+        pconn->pout = p;
+        pconn->out_sz = new_sz;
+    }
+    return pconn->pout + pconn->out_len;
+}
+
+
+// adds a reply with room for len bytes of payload after it
+// returns pointer to the payload, or NULL if out of memory
+static uint8_t * reply(
+    conn_t * pconn,
+    const wau8d_req_t * preq,
+    const wau8d_status_t status,
+    const uint64_t offset,
+    const uint32_t len)
+{
+    uint8_t * p = out_reserve(pconn, sizeof(wau8d_rep_t) + len);
+    wau8d_rep_t rep;
+
+    if (p == NULL)
+    {
+        return NULL;
+    }
+    rep.magic = WAU8D_REP_MAGIC;
+    rep.status = (uint32_t)status;
+    rep.stream = preq->stream;
+    rep.len = len;
+    rep.offset = offset;
+    rep.tag = preq->tag;
+    memcpy(p, &rep, sizeof(rep));
+    pconn->out_len += sizeof(rep) + len;
+    return p + sizeof(rep);
+}
+
+
+// payload bytes that follow a request
+static uint32_t payload_len(const wau8d_req_t * preq)
+{
+    return ((preq->op == WAU8D_OP_OPEN) || (preq->op == WAU8D_OP_XOR)) ? preq->len : 0U;
+}
+
+
+// maps the memfd that came with a map request as the shared buffer
+// the file has to be at least len bytes and sealed against shrinking,
+// or a client could make the daemon touch pages that aren't there (SIGBUS)
+static wau8d_status_t do_map(conn_t * pconn, const wau8d_req_t * preq)
+{
+    struct stat st;
+    int seals;
+    void * p = MAP_FAILED;
+
+    if (pconn->pending_fd < 0)
+    {
+        return WAU8D_E_MAP;
+    }
+    if (pconn->pshm != NULL)
+    {
+        munmap(pconn->pshm, pconn->shm_sz);
+        pconn->pshm = NULL;
+        pconn->shm_sz = 0U;
+    }
+
+    seals = fcntl(pconn->pending_fd, F_GET_SEALS);
+    if ((preq->len != 0U) &&
+        (seals >= 0) && ((seals & F_SEAL_SHRINK) != 0) &&
+        (fstat(pconn->pending_fd, &st) == 0) &&
+        ((uint64_t)st.st_size >= preq->len))
+    {
+        p = mmap(NULL, preq->len, PROT_READ | PROT_WRITE, MAP_SHARED, pconn->pending_fd, 0);
+    }
+    close(pconn->pending_fd);
+    pconn->pending_fd = -1;
+    if (p == MAP_FAILED)
+    {
+        return WAU8D_E_MAP;
+    }
+    pconn->pshm = (uint8_t *)p;
+    pconn->shm_sz = preq->len;
+    return WAU8D_OK;
+}
+
+
+// handles one request whose payload is in ppayload
+// returns -1 if the connection has to be closed
+static int handle(conn_t * pconn, const wau8d_req_t * preq, const uint8_t * ppayload)
+{
+    session_t * ps = NULL;
+    wau8d_status_t status = WAU8D_OK;
+    uint64_t offset = 0U;
+    uint8_t * pdst;
+
+    totals.requests++;
+
+    switch (preq->op)
+    {
+    case WAU8D_OP_OPEN:
+        if (preq->len != WAU8_KEY_SZ)
+        {
+            status = WAU8D_E_PROTO;
+            break;
+        }
+        ps = pool_get(pconn, preq->stream);
+        if (ps == NULL)
+        {
+            status = WAU8D_E_FULL;
+            break;
+        }
+        wau8_set_key(&ps->con, (const wau8_key_t)ppayload);
+        wau8_seek(&ps->con, (preq->offset == WAU8D_OFFSET_NEXT) ? 0U : preq->offset);
+        offset = wau8_get_offset(&ps->con);
+        break;
+
+    case WAU8D_OP_XOR:
+    case WAU8D_OP_XOR_SHM:
+        ps = pool_find(pconn->id, preq->stream);
+        if (ps == NULL)
+        {
+            status = WAU8D_E_STREAM;
+            break;
+        }
+        if (preq->op == WAU8D_OP_XOR_SHM)
+        {
+            if (pconn->pshm == NULL)
+            {
+                status = WAU8D_E_MAP;
+                break;
+            }
+            if ((preq->shm_pos > pconn->shm_sz) || (preq->len > (pconn->shm_sz - preq->shm_pos)))
+            {
+                status = WAU8D_E_RANGE;
+                break;
+            }
+        }
+        if (preq->offset != WAU8D_OFFSET_NEXT)
+        {
+            wau8_seek(&ps->con, preq->offset);
+        }
+        if (preq->op == WAU8D_OP_XOR)
+        {
+            // straight from the input buffer into the reply
+            pdst = reply(pconn, preq, WAU8D_OK, wau8_get_offset(&ps->con) + preq->len, preq->len);
+            if (pdst == NULL)
+            {
+                return -1;
+            }
+            wau8_xor(&ps->con, ppayload, pdst, preq->len);
+            totals.bytes += preq->len;
+            return 0;
+        }
+        wau8_xor_inplace(&ps->con, pconn->pshm + preq->shm_pos, preq->len);
+        totals.bytes += preq->len;
+        offset = wau8_get_offset(&ps->con);
+        break;
+
+    case WAU8D_OP_MAP:
+        status = do_map(pconn, preq);
+        break;
+
+    case WAU8D_OP_CLOSE:
+        ps = pool_find(pconn->id, preq->stream);
+        if (ps == NULL)
+        {
+            status = WAU8D_E_STREAM;
+            break;
+        }
+        offset = wau8_get_offset(&ps->con);
+        pool_put(pconn, ps);
+        break;
+
+    default:
+        status = WAU8D_E_PROTO;
+        break;
+    }
+
+    if (reply(pconn, preq, status, offset, 0U) == NULL)
+    {
+        return -1;
+    }
+    if (status == WAU8D_E_PROTO)
+    {
+        pconn->closing = 1;
+    }
+    return 0;
+}
+
+
+// handles every whole request in the input buffer
+// a partial request is moved to the front to wait for the rest
+static int process(conn_t * pconn)
+{
+    size_t pos = 0U;
+
+    while (!pconn->closing && ((pconn->in_len - pos) >= sizeof(wau8d_req_t)))
+    {
+        wau8d_req_t req;
+        size_t need;
+
+        memcpy(&req, pconn->pin + pos, sizeof(req));
+        if ((req.magic != WAU8D_REQ_MAGIC) || (payload_len(&req) > WAU8D_MAX_PAYLOAD))
+        {
+            req.op = 0U;
+            req.len = 0U;
+        }
+
+        need = sizeof(req) + payload_len(&req);
+        if ((pconn->in_len - pos) < need)
+        {
+            if (need > pconn->in_sz)
+            {
+                uint8_t * p = (uint8_t *)realloc(pconn->pin, need);
+                if (p == NULL)
+                {
+                    return -1;
+                }
+                pconn->pin = p;
+                pconn->in_sz = need;
+            }
+            break;
+        }
+
+        if (handle(pconn, &req, pconn->pin + pos + sizeof(req)) != 0)
+        {
+            return -1;
+        }
+        pos += need;
+    }
+
+    memmove(pconn->pin, pconn->pin + pos, pconn->in_len - pos);
+    pconn->in_len -= pos;
+    return 0;
+}
+
+
+// sends what output it can, then waits for input or for room to send more
+static int flush(conn_t * pconn)
+{
+    uint32_t events = EPOLLIN;
+
+    while (pconn->out_sent < pconn->out_len)
+    {
+        ssize_t n = send(pconn->fd, pconn->pout + pconn->out_sent,
+            pconn->out_len - pconn->out_sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            {
+                break;
+            }
+            return -1;
+        }
+        pconn->out_sent += (size_t)n;
+    }
+
+    if (pconn->out_sent == pconn->out_len)
+    {
+        pconn->out_sent = 0U;
+        pconn->out_len = 0U;
+        if (pconn->closing)
+        {
+            return -1;
+        }
+    }
+    else
+    {
+        events = EPOLLOUT;
+        if (((pconn->out_len - pconn->out_sent) < OUT_HIGH_WATER) && !pconn->closing)
+        {
+            events |= EPOLLIN;
+        }
+    }
+
+    return set_events(pconn, events);
+}
+
+
+// reads what has arrived, picking up a memfd if one came with it
+// returns -1 on error or when the client has gone
+static int receive(conn_t * pconn)
+{
+    union
+    {
+        struct cmsghdr hdr;
+        char buff[CMSG_SPACE(sizeof(int))];
+    } ctl;
+    struct msghdr msg;
+    struct iovec iov;
+    struct cmsghdr * pcmsg;
+    ssize_t n;
+
+    if (pconn->in_len == pconn->in_sz)
+    {
+        return 0;
+    }
+
+    iov.iov_base = pconn->pin + pconn->in_len;
+    iov.iov_len = pconn->in_sz - pconn->in_len;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctl.buff;
+    msg.msg_controllen = sizeof(ctl.buff);
+
+    n = recvmsg(pconn->fd, &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+    if (n < 0)
+    {
+        return ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) ? 0 : -1;
+    }
+    if (n == 0)
+    {
+        return -1;
+    }
+
+    for (pcmsg = CMSG_FIRSTHDR(&msg); pcmsg != NULL; pcmsg = CMSG_NXTHDR(&msg, pcmsg))
+    {
+        if ((pcmsg->cmsg_level == SOL_SOCKET) && (pcmsg->cmsg_type == SCM_RIGHTS))
+        {
+            if (pconn->pending_fd >= 0)
+            {
+                close(pconn->pending_fd);
+            }
+            memcpy(&pconn->pending_fd, CMSG_DATA(pcmsg), sizeof(int));
+        }
+    }
+
+    pconn->in_len += (size_t)n;
+    return 0;
+}
+
+
+static void accept_all(const int lfd)
+{
+    for (;;)
+    {
+        struct epoll_event ev;
+        conn_t * pconn;
+        int fd = accept4(lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (fd < 0)
+        {
+            return;
+        }
+
+        pconn = (conn_t *)calloc(1U, sizeof(conn_t));
+        if (pconn != NULL)
+        {
+            pconn->pin = (uint8_t *)malloc(IN_START_SZ);
+        }
+        if ((pconn == NULL) || (pconn->pin == NULL))
+        {
+            free(pconn);
+            close(fd);
+            continue;
+        }
+
+        pconn->fd = fd;
+        pconn->id = next_conn_id++;
+        pconn->in_sz = IN_START_SZ;
+        pconn->pending_fd = -1;
+        pconn->events = EPOLLIN;
+        ev.events = EPOLLIN;
+        ev.data.ptr = pconn;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) != 0)
+        {
+            free(pconn->pin);
+            free(pconn);
+            close(fd);
+            continue;
+        }
+        totals.conns++;
+    }
+}
+
+
+// the socket is made with only the owner allowed in, so other users can't
+// use the keys, mode widens that after bind for sharing with a group
+// a stale socket left by an earlier run is removed but nothing else is
+static int listen_on(const char * path, const mode_t mode)
+{
+    struct sockaddr_un addr;
+    struct stat st;
+    mode_t old_mask;
+    int fd;
+    int result;
+
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        fprintf(stderr, "%s: socket path too long\n", path);
+        return -1;
+    }
+
+    if (lstat(path, &st) == 0)
+    {
+        if (!S_ISSOCK(st.st_mode))
+        {
+            fprintf(stderr, "%s: exists and is not a socket\n", path);
+            return -1;
+        }
+        unlink(path);
+    }
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        perror("socket");
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    // the umask makes the socket 0600 from the start so there's no window
+    // where it can be connected to by anyone else
+    old_mask = umask(0177);
+    result = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+    umask(old_mask);
+
+    if ((result != 0) || (chmod(path, mode) != 0) || (listen(fd, SOMAXCONN) != 0))
+    {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+
+static void usage(void)
+{
+    fprintf(stderr,
+        "usage: wau8d -S SOCKET -w WHEELS|-s SEED [options]\n"
+        "  -S SOCKET   path of the Unix domain socket to listen on\n"
+        "  -m MODE     permissions of the socket in octal (default 600)\n"
+        "  -w WHEELS   file holding a raw wau8_wheels_t (%u bytes)\n"
+        "  -s SEED     make wheels from a seed with wau8_make_wheels instead\n"
+        "  -n COUNT    sessions in the pool (default %u)\n",
+        (unsigned int)sizeof(wau8_wheels_t),
+        DEFAULT_SESSIONS);
+}
+
+
+int main(int argc, char* argv[])
+{
+    const char * spath = NULL;
+    const char * wpath = NULL;
+    const char * seed_str = NULL;
+    uint32_t nsessions = DEFAULT_SESSIONS;
+    mode_t mode = 0600;
+    struct epoll_event events[MAX_EVENTS];
+    struct epoll_event ev;
+    struct sigaction sa;
+    int lfd;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "S:m:w:s:n:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'S': spath = optarg; break;
+        case 'm': mode = (mode_t)strtoul(optarg, NULL, 8) & 0777; break;
+        case 'w': wpath = optarg; break;
+        case 's': seed_str = optarg; break;
+        case 'n': nsessions = (uint32_t)strtoul(optarg, NULL, 0); break;
+        default: usage(); return 2;
+        }
+    }
+
+    if ((spath == NULL) || ((wpath == NULL) == (seed_str == NULL)) || (nsessions == 0U))
+    {
+        usage();
+        return 2;
+    }
+
+    if (seed_str != NULL)
+    {
+        wau8_make_wheels(&wheels, strtoull(seed_str, NULL, 0));
+    }
+    else if (load_wheels(wpath) != 0)
+    {
+        return 1;
+    }
+    wau8_make_ext_wheels(&xwheels, &wheels);
+    wau8_make_fused_wheels(&fwheels, &wheels);
+
+    if (pool_init(nsessions) != 0)
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    lfd = listen_on(spath, mode);
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if ((lfd < 0) || (epfd < 0))
+    {
+        return 1;
+    }
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, lfd, &ev);
+
+    while (!stop)
+    {
+        int n = epoll_wait(epfd, events, MAX_EVENTS, -1);
+        int ii;
+
+        for (ii = 0; ii < n; ii++)
+        {
+            conn_t * pconn = (conn_t *)events[ii].data.ptr;
+            int err = 0;
+
+            if (pconn == NULL)
+            {
+                accept_all(lfd);
+                continue;
+            }
+
+            if (events[ii].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+            {
+                err = receive(pconn);
+                if ((err == 0) && (process(pconn) != 0))
+                {
+                    err = -1;
+                }
+                totals.batches++;
+            }
+            if (err == 0)
+            {
+                err = flush(pconn);
+            }
+            if (err != 0)
+            {
+                conn_close(pconn);
+            }
+        }
+    }
+
+    unlink(spath);
+    fprintf(stderr, "wau8d: %llu connections, %llu requests in %llu batches, %llu bytes\n",
+        (unsigned long long)totals.conns,
+        (unsigned long long)totals.requests,
+        (unsigned long long)totals.batches,
+        (unsigned long long)totals.bytes);
+    return 0;
+}
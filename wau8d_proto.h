@@ -0,0 +1,114 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#ifndef WAU8D_PROTO_H_
+#define WAU8D_PROTO_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// protocol between wau8d and its clients (wau8_client.h)
+//
+// a client connects to the daemon's Unix domain socket and sends
+// requests, each a wau8d_req_t followed by len bytes of payload
+// the daemon answers every request in order with a wau8d_rep_t
+// followed by len bytes of payload
+// requests may be pipelined, the tag is copied into the reply
+// both ends are on the same machine so fields are in host byte order
+//
+// WAU8D_OP_OPEN   payload is the key, starts (or restarts) a stream
+//                 at offset in the daemon's session pool
+// WAU8D_OP_XOR    payload is data, reply payload is the data XORed with
+//                 the stream's keystream from offset, or from where the
+//                 stream left off if offset is WAU8D_OFFSET_NEXT
+// WAU8D_OP_MAP    no payload, a memfd of len bytes comes with the request
+//                 (SCM_RIGHTS) and is mapped as the connection's shared buffer
+//                 (the memfd must be at least len bytes and have F_SEAL_SHRINK)
+// WAU8D_OP_XOR_SHM  XORs len bytes of the shared buffer at shm_pos in place
+//                 so the data is never copied through the socket
+// WAU8D_OP_CLOSE  ends a stream and returns its session to the pool
+//
+// streams belong to the connection that opened them
+// the reply offset is the stream's keystream offset after the request
+
+#define WAU8D_REQ_MAGIC         (0x51523857U)   // "W8RQ"
+#define WAU8D_REP_MAGIC         (0x50523857U)   // "W8RP"
+
+// largest payload of one request, bigger messages are split by the client
+#define WAU8D_MAX_PAYLOAD       (1U << 20U)
+
+#define WAU8D_OFFSET_NEXT       (UINT64_MAX)
+
+typedef enum
+{
+    WAU8D_OP_OPEN = 1,
+    WAU8D_OP_XOR,
+    WAU8D_OP_MAP,
+    WAU8D_OP_XOR_SHM,
+    WAU8D_OP_CLOSE,
+} wau8d_op_t;
+
+typedef enum
+{
+    WAU8D_OK = 0,
+    WAU8D_E_PROTO,      // bad request, the connection is closed after the reply
+    WAU8D_E_STREAM,     // stream not open
+    WAU8D_E_FULL,       // session pool full
+    WAU8D_E_MAP,        // no shared buffer, or it couldn't be mapped
+    WAU8D_E_RANGE,      // shared buffer range out of bounds
+} wau8d_status_t;
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t op;
+    uint16_t reserved;
+    uint32_t stream;
+    uint32_t len;
+    uint64_t offset;
+    uint64_t shm_pos;
+    uint64_t tag;
+} wau8d_req_t;
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t status;
+    uint32_t stream;
+    uint32_t len;
+    uint64_t offset;
+    uint64_t tag;
+} wau8d_rep_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WAU8D_PROTO_H_
@@ -0,0 +1,291 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+// load generator for wau8d
+// each client thread has its own connection and stream and sends
+// messages one after another, timing each request
+// reports requests and bytes per second and latency percentiles
+// over all clients, and with -s checks every reply against wau8_xor
+// POSIX only
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "wau8.h"
+#include "wau8_client.h"
+#include "wau8d_proto.h"
+
+#define DEFAULT_CLIENTS     (4)
+#define DEFAULT_REQUESTS    (100000U)
+#define DEFAULT_MSG_SZ      (256U)
+
+
+typedef struct
+{
+    pthread_t thread;
+    unsigned int index;
+    double * plat;          // seconds per request
+    unsigned int done;      // requests that got a reply
+    uint64_t mismatches;
+    int err;
+} worker_t;
+
+static const char * spath = NULL;
+static unsigned int nrequests = DEFAULT_REQUESTS;
+static size_t msg_sz = DEFAULT_MSG_SZ;
+static int use_shm = 0;
+static int check = 0;
+static wau8_wheels_t wheels;
+static wau8_ext_wheels_t xwheels;
+
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+
+static int cmp_double(const void * pa, const void * pb)
+{
+    double a = *(const double *)pa;
+    double b = *(const double *)pb;
+    return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+
+static void * worker_main(void * parg)
+{
+    worker_t * pw = (worker_t *)parg;
+    wau8_client_t client;
+    wau8_context_t con;
+    uint8_t key[WAU8_KEY_SZ];
+    uint8_t * psrc = (uint8_t *)malloc(msg_sz);
+    uint8_t * pdst = (uint8_t *)malloc(msg_sz);
+    uint8_t * pref = (uint8_t *)malloc(msg_sz);
+    unsigned int ii;
+
+    pw->err = -1;
+    if ((psrc == NULL) || (pdst == NULL) || (pref == NULL) ||
+        (wau8_client_connect(&client, spath) != 0))
+    {
+        perror(spath);
+        free(psrc);
+        free(pdst);
+        free(pref);
+        return NULL;
+    }
+
+    for (ii = 0; ii < WAU8_KEY_SZ; ii++)
+    {
+        key[ii] = (uint8_t)((pw->index * 37U) + (ii * 11U));
+    }
+    for (ii = 0; ii < msg_sz; ii++)
+    {
+        psrc[ii] = (uint8_t)(ii ^ pw->index);
+    }
+    wau8_set_wheels(&con, &wheels);
+    wau8_set_ext_wheels(&con, &xwheels);
+    wau8_set_key(&con, &key);
+
+    if ((wau8_client_open(&client, 1U, &key, 0U) != 0) ||
+        (use_shm && (wau8_client_map(&client, msg_sz) != 0)))
+    {
+        fprintf(stderr, "client %u: open failed\n", pw->index);
+        wau8_client_disconnect(&client);
+        free(psrc);
+        free(pdst);
+        free(pref);
+        return NULL;
+    }
+
+    for (ii = 0; ii < nrequests; ii++)
+    {
+        double t0;
+        int result;
+
+        if (use_shm)
+        {
+            memcpy(client.pshm, psrc, msg_sz);
+            t0 = now();
+            result = wau8_client_xor_shm(&client, 1U, WAU8D_OFFSET_NEXT, 0U, msg_sz);
+            pw->plat[ii] = now() - t0;
+            memcpy(pdst, client.pshm, msg_sz);
+        }
+        else
+        {
+            t0 = now();
+            result = wau8_client_xor(&client, 1U, WAU8D_OFFSET_NEXT, psrc, pdst, msg_sz);
+            pw->plat[ii] = now() - t0;
+        }
+
+        if (result != 0)
+        {
+            fprintf(stderr, "client %u: request failed (%d)\n", pw->index, result);
+            break;
+        }
+        if (check)
+        {
+            wau8_xor(&con, psrc, pref, msg_sz);
+            if (memcmp(pref, pdst, msg_sz) != 0)
+            {
+                pw->mismatches++;
+            }
+        }
+    }
+
+    pw->done = ii;
+    if (ii == nrequests)
+    {
+        wau8_client_close(&client, 1U);
+        pw->err = 0;
+    }
+    wau8_client_disconnect(&client);
+    free(psrc);
+    free(pdst);
+    free(pref);
+    return NULL;
+}
+
+
+static void usage(void)
+{
+    fprintf(stderr,
+        "usage: wau8load -S SOCKET [options]\n"
+        "  -S SOCKET   path of the daemon's socket\n"
+        "  -c CLIENTS  concurrent clients, one thread each (default %d)\n"
+        "  -n COUNT    requests per client (default %u)\n"
+        "  -b BYTES    bytes per request (default %u)\n"
+        "  -m          pass data through a shared buffer instead of the socket\n"
+        "  -s SEED     check replies against wheels made from the daemon's seed\n",
+        DEFAULT_CLIENTS,
+        DEFAULT_REQUESTS,
+        DEFAULT_MSG_SZ);
+}
+
+
+int main(int argc, char* argv[])
+{
+    int nclients = DEFAULT_CLIENTS;
+    worker_t * pworkers;
+    double * plat;
+    uint64_t mismatches = 0U;
+    size_t total;
+    size_t count = 0U;
+    double t0;
+    double secs;
+    int failed = 0;
+    int opt;
+    int ii;
+
+    while ((opt = getopt(argc, argv, "S:c:n:b:ms:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'S': spath = optarg; break;
+        case 'c': nclients = atoi(optarg); break;
+        case 'n': nrequests = (unsigned int)strtoul(optarg, NULL, 0); break;
+        case 'b': msg_sz = (size_t)strtoull(optarg, NULL, 0); break;
+        case 'm': use_shm = 1; break;
+        case 's':
+            wau8_make_wheels(&wheels, strtoull(optarg, NULL, 0));
+            wau8_make_ext_wheels(&xwheels, &wheels);
+            check = 1;
+            break;
+        default: usage(); return 2;
+        }
+    }
+
+    if ((spath == NULL) || (nclients < 1) || (nrequests == 0U) || (msg_sz == 0U) ||
+        (use_shm && (msg_sz > UINT32_MAX)))
+    {
+        usage();
+        return 2;
+    }
+
+    total = (size_t)nclients * nrequests;
+    pworkers = (worker_t *)calloc((size_t)nclients, sizeof(worker_t));
+    plat = (double *)calloc(total, sizeof(double));
+    if ((pworkers == NULL) || (plat == NULL))
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    t0 = now();
+    for (ii = 0; ii < nclients; ii++)
+    {
+        pworkers[ii].index = (unsigned int)ii;
+        pworkers[ii].plat = plat + ((size_t)ii * nrequests);
+        pthread_create(&pworkers[ii].thread, NULL, worker_main, &pworkers[ii]);
+    }
+    for (ii = 0; ii < nclients; ii++)
+    {
+        pthread_join(pworkers[ii].thread, NULL);
+        mismatches += pworkers[ii].mismatches;
+        failed |= pworkers[ii].err;
+    }
+    secs = now() - t0;
+
+    // only requests that got a reply have a latency, a client that failed
+    // leaves the rest of its samples unset so they are dropped here
+    for (ii = 0; ii < nclients; ii++)
+    {
+        memmove(plat + count, pworkers[ii].plat, pworkers[ii].done * sizeof(double));
+        count += pworkers[ii].done;
+    }
+
+    printf("clients:     %d\n", nclients);
+    printf("requests:    %llu of %llu bytes%s\n",
+        (unsigned long long)count, (unsigned long long)msg_sz,
+        use_shm ? " (shared buffer)" : "");
+    if (count > 0U)
+    {
+        qsort(plat, count, sizeof(double), cmp_double);
+        printf("throughput:  %.0f requests/s, %.1f MB/s\n",
+            (double)count / secs, ((double)count * (double)msg_sz) / (secs * 1e6));
+        printf("latency us:  p50 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+            plat[count / 2U] * 1e6,
+            plat[(count * 99U) / 100U] * 1e6,
+            plat[(count * 999U) / 1000U] * 1e6,
+            plat[count - 1U] * 1e6);
+    }
+    if (check)
+    {
+        printf("mismatches:  %llu\n", (unsigned long long)mismatches);
+    }
+
+    free(plat);
+    free(pworkers);
+    return (failed || (mismatches != 0U)) ? 1 : 0;
+}
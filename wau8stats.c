@@ -0,0 +1,530 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+// command-line tool for checking the statistical quality of keystream
+// for each wheel set it streams keystream through:
+// - byte histogram and chi-square
+// - byte pair histogram (lag 1, overlapping pairs) and Good's serial
+//   statistic, which takes out the byte part so it is chi-square
+// - bit balance of each bit position
+// - serial correlation at lags 1 to 16 and at each wheel size
+//   (a lag equal to a wheel's size lines that wheel up with itself)
+// the stream is split into chunks that threads make on their own
+// by seeking a copy of the context to each chunk's offset
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "wau8.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define DEFAULT_SZ          (1ULL << 30U)
+#define BLOCK_SZ            (8U * 1024U)        // 16-bit copy of a block stays in L1
+#define FLUSH_BLOCKS        (65535U / BLOCK_SZ) // blocks before 16-bit pair counts fill
+#define CHUNKS_PER_THREAD   (4)
+#define MAX_SETS            (64U)
+#define MAX_LAGS            (16U + WAU8_KEY_SZ)
+#define HIST_COPIES         (4U)            // separate tables so repeats don't stall
+#define FAIL_Z              (4.5)           // about 1 in 150000 for a normal variable
+
+
+typedef struct
+{
+    uint64_t hist[256];
+    uint64_t pairs[256 * 256];
+    uint64_t prods[MAX_LAGS];
+    uint64_t count;
+} stats_t;
+
+typedef struct
+{
+    const char * name;
+    wau8_wheels_t wheels;
+} wheel_set_t;
+
+
+static wheel_set_t sets[MAX_SETS];
+static size_t nsets = 0U;
+static unsigned int lags[MAX_LAGS];
+static size_t nlags = 0U;
+static unsigned int max_lag = 0U;
+
+
+static void add_lag(const unsigned int lag)
+{
+    size_t ii;
+
+    for (ii = 0; ii < nlags; ii++)
+    {
+        if (lags[ii] == lag)
+        {
+            return;
+        }
+    }
+
+    lags[nlags++] = lag;
+    if (lag > max_lag)
+    {
+        max_lag = lag;
+    }
+}
+
+
+// every lag from 1 to 16 plus one for each wheel
+static void init_lags(void)
+{
+    unsigned int lag;
+    size_t ii;
+
+    for (lag = 1U; lag <= 16U; lag++)
+    {
+        add_lag(lag);
+    }
+    for (ii = 0; ii < WAU8_KEY_SZ; ii++)
+    {
+        add_lag(WAU8_WHEEL_SZ[ii]);
+    }
+}
+
+
+// counts one block
+// pbuff holds the block followed by max_lag more bytes of keystream
+static void count_block(
+    const uint8_t * pbuff,
+    int16_t * pwide,
+    const size_t sz,
+    uint32_t hist[HIST_COPIES][256],
+    uint16_t * ppairs,
+    uint64_t * pprods)
+{
+    size_t ii;
+    size_t jj;
+
+    for (jj = 0; (jj + HIST_COPIES) <= sz; jj += HIST_COPIES)
+    {
+        hist[0][pbuff[jj]]++;
+        hist[1][pbuff[jj + 1U]]++;
+        hist[2][pbuff[jj + 2U]]++;
+        hist[3][pbuff[jj + 3U]]++;
+    }
+    for (; jj < sz; jj++)
+    {
+        hist[0][pbuff[jj]]++;
+    }
+
+    for (jj = 0; jj < sz; jj++)
+    {
+        ppairs[((unsigned int)pbuff[jj] << 8U) | pbuff[jj + 1U]]++;
+    }
+
+    // widened to 16 bits so each lag is a dot product the compiler can
+    // vectorize with multiply-add instructions
+    for (jj = 0; jj < (sz + max_lag); jj++)
+    {
+        pwide[jj] = pbuff[jj];
+    }
+    for (ii = 0; ii < nlags; ii++)
+    {
+        const int16_t * plag = pwide + lags[ii];
+        int32_t sum = 0;
+        for (jj = 0; jj < sz; jj++)
+        {
+            sum += (int32_t)pwide[jj] * (int32_t)plag[jj];
+        }
+        pprods[ii] += (uint32_t)sum;
+    }
+}
+
+
+static void flush_counts(
+    stats_t * pstats,
+    uint32_t hist[HIST_COPIES][256],
+    uint16_t * ppairs)
+{
+    size_t ii;
+    size_t kk;
+
+    for (ii = 0; ii < 256U; ii++)
+    {
+        for (kk = 0; kk < HIST_COPIES; kk++)
+        {
+            pstats->hist[ii] += hist[kk][ii];
+        }
+    }
+    for (ii = 0; ii < (256U * 256U); ii++)
+    {
+        pstats->pairs[ii] += ppairs[ii];
+    }
+
+    memset(hist, 0, HIST_COPIES * 256U * sizeof(uint32_t));
+    memset(ppairs, 0, 256U * 256U * sizeof(uint16_t));
+}
+
+
+// makes and counts keystream from offset start up to offset end
+// returns non-zero if out of memory
+static int run_chunk(
+    const wau8_context_t * pcontext,
+    const uint64_t start,
+    const uint64_t end,
+    stats_t * pstats)
+{
+    uint8_t * pbuff = (uint8_t *)malloc(BLOCK_SZ + max_lag);
+    int16_t * pwide = (int16_t *)malloc((BLOCK_SZ + max_lag) * sizeof(int16_t));
+    uint16_t * ppairs = (uint16_t *)calloc(256U * 256U, sizeof(uint16_t));
+    uint32_t hist[HIST_COPIES][256];
+    wau8_context_t con = *pcontext;
+    uint64_t pos = start;
+    unsigned int nblocks = 0U;
+
+    if ((pbuff == NULL) || (pwide == NULL) || (ppairs == NULL))
+    {
+        free(pbuff);
+        free(pwide);
+        free(ppairs);
+        return -1;
+    }
+
+    memset(hist, 0, sizeof(hist));
+    wau8_seek(&con, start);
+    wau8_keystream(&con, pbuff, max_lag);
+
+    while (pos < end)
+    {
+        size_t n = ((end - pos) < BLOCK_SZ) ? (size_t)(end - pos) : BLOCK_SZ;
+
+        // keep the last max_lag bytes of the previous block at the front
+        wau8_keystream(&con, pbuff + max_lag, n);
+        count_block(pbuff, pwide, n, hist, ppairs, pstats->prods);
+        memmove(pbuff, pbuff + n, max_lag);
+        pos += n;
+
+        if (++nblocks == FLUSH_BLOCKS)
+        {
+            flush_counts(pstats, hist, ppairs);
+            nblocks = 0U;
+        }
+    }
+
+    flush_counts(pstats, hist, ppairs);
+    pstats->count += end - start;
+    free(pbuff);
+    free(pwide);
+    free(ppairs);
+    return 0;
+}
+
+
+// splits the stream into chunks across the threads and adds up the counts
+static int run_set(
+    const wau8_context_t * pcontext,
+    const uint64_t sz,
+    const int nthreads,
+    stats_t * ptotal)
+{
+    const ptrdiff_t nchunks = (ptrdiff_t)nthreads * CHUNKS_PER_THREAD;
+    const uint64_t chunk_sz = (sz + (uint64_t)nchunks - 1U) / (uint64_t)nchunks;
+    int err = 0;
+    ptrdiff_t cc;
+
+    memset(ptotal, 0, sizeof(*ptotal));
+
+#pragma omp parallel num_threads(nthreads)
+    {
+        stats_t * pstats = (stats_t *)calloc(1U, sizeof(stats_t));
+        int my_err = (pstats == NULL);
+
+#pragma omp for schedule(static)
+        for (cc = 0; cc < nchunks; cc++)
+        {
+            uint64_t start = (uint64_t)cc * chunk_sz;
+            uint64_t end = ((start + chunk_sz) < sz) ? (start + chunk_sz) : sz;
+            if (!my_err && (start < end))
+            {
+                my_err = run_chunk(pcontext, start, end, pstats);
+            }
+        }
+
+#pragma omp critical
+        {
+            if (my_err)
+            {
+                err = 1;
+            }
+            else
+            {
+                size_t ii;
+                for (ii = 0; ii < 256U; ii++)
+                {
+                    ptotal->hist[ii] += pstats->hist[ii];
+                }
+                for (ii = 0; ii < (256U * 256U); ii++)
+                {
+                    ptotal->pairs[ii] += pstats->pairs[ii];
+                }
+                for (ii = 0; ii < nlags; ii++)
+                {
+                    ptotal->prods[ii] += pstats->prods[ii];
+                }
+                ptotal->count += pstats->count;
+            }
+        }
+        free(pstats);
+    }
+
+    return err ? -1 : 0;
+}
+
+
+// chi-square sum of counts against a flat distribution
+static double chi2_sum(const uint64_t * pcounts, const size_t ncells, const uint64_t total)
+{
+    const double expected = (double)total / (double)ncells;
+    double chi2 = 0.0;
+    size_t ii;
+
+    for (ii = 0; ii < ncells; ii++)
+    {
+        double d = (double)pcounts[ii] - expected;
+        chi2 += (d * d) / expected;
+    }
+    return chi2;
+}
+
+
+// chi-square statistic as a normal deviate (Wilson-Hilferty)
+static double chi2_z(const double chi2, const double dof)
+{
+    return (pow(chi2 / dof, 1.0 / 3.0) - (1.0 - (2.0 / (9.0 * dof)))) /
+        sqrt(2.0 / (9.0 * dof));
+}
+
+
+static int check(const char * what, const double z)
+{
+    int ok = (fabs(z) <= FAIL_Z);
+    printf("  %-28s z = %8.3f  %s\n", what, z, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+
+// prints the summary for one wheel set, returns non-zero if it passes
+static int report(const wheel_set_t * pset, const stats_t * pstats, const double secs)
+{
+    const double n = (double)pstats->count;
+    double mean = 0.0;
+    double var = 0.0;
+    uint64_t ones[8] = { 0U };
+    double byte_chi2;
+    double pair_chi2;
+    int ok = 1;
+    char what[64];
+    size_t ii;
+    unsigned int bit;
+
+    for (ii = 0; ii < 256U; ii++)
+    {
+        mean += (double)ii * (double)pstats->hist[ii];
+        var += (double)ii * (double)ii * (double)pstats->hist[ii];
+        for (bit = 0; bit < 8U; bit++)
+        {
+            if ((ii >> bit) & 1U)
+            {
+                ones[bit] += pstats->hist[ii];
+            }
+        }
+    }
+    mean /= n;
+    var = (var / n) - (mean * mean);
+
+    printf("%s: %llu bytes in %.2f s (%.1f MB/s)\n",
+        pset->name, (unsigned long long)pstats->count, secs, (n / secs) / 1e6);
+
+    // overlapping pairs aren't independent so their chi-square sum isn't
+    // chi-square distributed, but less the byte sum it is (Good's serial
+    // test), with 256 x 256 - 256 degrees of freedom
+    byte_chi2 = chi2_sum(pstats->hist, 256U, pstats->count);
+    pair_chi2 = chi2_sum(pstats->pairs, 256U * 256U, pstats->count);
+    ok &= check("byte chi-square", chi2_z(byte_chi2, 255.0));
+    ok &= check("byte pair serial", chi2_z(pair_chi2 - byte_chi2, (256.0 * 256.0) - 256.0));
+
+    for (bit = 0; bit < 8U; bit++)
+    {
+        snprintf(what, sizeof(what), "bit %u balance", bit);
+        ok &= check(what, ((double)ones[bit] - (n / 2.0)) / sqrt(n / 4.0));
+    }
+
+    for (ii = 0; ii < nlags; ii++)
+    {
+        // a constant stream has no variance to correlate
+        double r = (var > 0.0) ?
+            ((((double)pstats->prods[ii] / n) - (mean * mean)) / var) : 1.0;
+        snprintf(what, sizeof(what), "correlation at lag %u", lags[ii]);
+        ok &= check(what, r * sqrt(n));
+    }
+
+    printf("  %s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+
+static int load_wheels(const char * path, wau8_wheels_t * pwheels)
+{
+    FILE * pf = fopen(path, "rb");
+    size_t n;
+
+    if (pf == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    n = fread(pwheels, 1U, sizeof(*pwheels), pf);
+    fclose(pf);
+    if (n != sizeof(*pwheels))
+    {
+        fprintf(stderr, "%s: expected %u bytes of wheel data\n",
+            path, (unsigned int)sizeof(*pwheels));
+        return -1;
+    }
+
+    return 0;
+}
+
+
+static void usage(void)
+{
+    fprintf(stderr,
+        "usage: wau8stats [-n BYTES] [-t THREADS] -w WHEELS|-s SEED ...\n"
+        "  -n BYTES    keystream bytes per wheel set (default %llu)\n"
+        "  -t THREADS  worker threads (default OpenMP default)\n"
+        "  -w WHEELS   file holding a raw wau8_wheels_t (%u bytes)\n"
+        "  -s SEED     wheels made by wau8_make_wheels from a seed\n"
+        "-w and -s can be given up to %u times in all\n",
+        (unsigned long long)DEFAULT_SZ,
+        (unsigned int)sizeof(wau8_wheels_t),
+        MAX_SETS);
+}
+
+
+int main(int argc, char* argv[])
+{
+    static const uint8_t key[WAU8_KEY_SZ] = { 0 };
+    static wau8_ext_wheels_t xwheels;
+    static stats_t stats;
+    uint64_t sz = DEFAULT_SZ;
+    int nthreads = 1;
+    int all_ok = 1;
+    size_t ii;
+    int aa;
+
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+
+    for (aa = 1; aa < argc; aa++)
+    {
+        const char * parg = ((aa + 1) < argc) ? argv[aa + 1] : NULL;
+
+        if ((parg == NULL) || (nsets == MAX_SETS))
+        {
+            usage();
+            return 2;
+        }
+        else if (strcmp(argv[aa], "-n") == 0)
+        {
+            sz = strtoull(parg, NULL, 0);
+        }
+        else if (strcmp(argv[aa], "-t") == 0)
+        {
+            nthreads = atoi(parg);
+        }
+        else if (strcmp(argv[aa], "-w") == 0)
+        {
+            if (load_wheels(parg, &sets[nsets].wheels) != 0)
+            {
+                return 1;
+            }
+            sets[nsets++].name = parg;
+        }
+        else if (strcmp(argv[aa], "-s") == 0)
+        {
+            wau8_make_wheels(&sets[nsets].wheels, strtoull(parg, NULL, 0));
+            sets[nsets++].name = parg;
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+        aa++;
+    }
+
+    if ((nsets == 0U) || (sz == 0U) || (nthreads < 1))
+    {
+        usage();
+        return 2;
+    }
+
+    init_lags();
+
+    for (ii = 0; ii < nsets; ii++)
+    {
+        wau8_context_t con;
+        double t0;
+
+        wau8_make_ext_wheels(&xwheels, &sets[ii].wheels);
+        wau8_set_wheels(&con, &sets[ii].wheels);
+        wau8_set_ext_wheels(&con, &xwheels);
+        wau8_set_key(&con, &key);
+
+#ifdef _OPENMP
+        t0 = omp_get_wtime();
+#else
+        t0 = (double)clock() / CLOCKS_PER_SEC;
+#endif
+        if (run_set(&con, sz, nthreads, &stats) != 0)
+        {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+#ifdef _OPENMP
+        t0 = omp_get_wtime() - t0;
+#else
+        t0 = ((double)clock() / CLOCKS_PER_SEC) - t0;
+#endif
+
+        all_ok &= report(&sets[ii], &stats, t0);
+    }
+
+    return all_ok ? 0 : 1;
+}
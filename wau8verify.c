@@ -0,0 +1,151 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+// command-line tool for checking candidate wheel geometries
+// prints period and coverage for a list of wheel sizes and checks them
+// exhaustively if the joint position space is small enough, or by sampling
+// with no sizes it checks the geometry the library was built with
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "wau8_verify.h"
+
+#define MAX_WHEELS          (64U)
+
+
+static void usage(void)
+{
+    fprintf(stderr,
+        "usage: wau8verify [-b MAXBITS] [-n SAMPLES] [-t THREADS] [SIZE ...]\n"
+        "  -b MAXBITS  exhaustive check up to this many joint positions (default %llu)\n"
+        "  -n SAMPLES  random joint positions to check otherwise (default %llu)\n"
+        "  -t THREADS  worker threads (default OpenMP default)\n",
+        (unsigned long long)WAU8_VERIFY_MAX_BITS,
+        (unsigned long long)WAU8_VERIFY_SAMPLES);
+}
+
+
+int main(int argc, char* argv[])
+{
+    uint16_t sizes[MAX_WHEELS];
+    size_t count = 0U;
+    wau8_verify_cfg_t cfg;
+    wau8_verify_result_t result;
+    int ii;
+
+    wau8_verify_init_cfg(&cfg);
+
+    for (ii = 1; ii < argc; ii++)
+    {
+        if ((strcmp(argv[ii], "-b") == 0) && ((ii + 1) < argc))
+        {
+            cfg.max_bits = strtoull(argv[++ii], NULL, 0);
+        }
+        else if ((strcmp(argv[ii], "-n") == 0) && ((ii + 1) < argc))
+        {
+            cfg.samples = strtoull(argv[++ii], NULL, 0);
+        }
+        else if ((strcmp(argv[ii], "-t") == 0) && ((ii + 1) < argc))
+        {
+            cfg.nthreads = atoi(argv[++ii]);
+        }
+        else
+        {
+            unsigned long sz = strtoul(argv[ii], NULL, 0);
+            if ((sz == 0U) || (sz > 0xFFFFU) || (count == MAX_WHEELS))
+            {
+                usage();
+                return 2;
+            }
+            sizes[count++] = (uint16_t)sz;
+        }
+    }
+
+    if (count == 0U)
+    {
+        memcpy(sizes, WAU8_WHEEL_SZ, sizeof(WAU8_WHEEL_SZ));
+        count = WAU8_KEY_SZ;
+    }
+
+    wau8_verify(sizes, count, &cfg, &result);
+
+    printf("wheels:   ");
+    for (ii = 0; ii < (int)count; ii++)
+    {
+        printf(" %u", (unsigned int)sizes[ii]);
+    }
+    printf("\n");
+
+    printf("period:    2^%.2f", result.log2_period);
+    if (result.period != 0U)
+    {
+        printf(" (%llu)", (unsigned long long)result.period);
+    }
+    printf("\n");
+
+    printf("positions: 2^%.2f", result.log2_states);
+    if (result.states != 0U)
+    {
+        printf(" (%llu)", (unsigned long long)result.states);
+    }
+    printf("\n");
+
+    if (result.full_coverage)
+    {
+        printf("coverage:  full\n");
+    }
+    else
+    {
+        // each start reaches one of this many separate cycles
+        if ((result.period != 0U) && (result.states != 0U))
+        {
+            printf("coverage:  1/%llu", (unsigned long long)(result.states / result.period));
+        }
+        else
+        {
+            printf("coverage:  1/2^%.2f", result.log2_states - result.log2_period);
+        }
+        printf(" of joint positions reached from any start (sizes %u and %u share a factor)\n",
+            (unsigned int)sizes[result.share_i],
+            (unsigned int)sizes[result.share_j]);
+    }
+
+    if (result.checked == 0U)
+    {
+        printf("checked:   nothing (period doesn't fit in 64 bits)\n");
+    }
+    else
+    {
+        printf("checked:   %llu joint positions %s, %llu failures\n",
+            (unsigned long long)result.checked,
+            result.exhaustive ? "exhaustively" : "by sampling",
+            (unsigned long long)result.failures);
+    }
+
+    return (result.failures == 0U) ? 0 : 1;
+}
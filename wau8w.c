@@ -0,0 +1,179 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#include <string.h>
+#include "wau8w.h"
+#include "wau8_util.h"
+
+
+// set initial wheel positions (the key)
+#define GEN_SET_KEY(nm, ix, sz) \
+    pcontext->pos##nm = (WAU8_POS_T)((*pkey)[ix] % (sz)); \
+    pcontext->key[ix] = pcontext->pos##nm;
+
+void wau8w_set_key(wau8w_context_t * pcontext, const wau8_key_t pkey)
+{
+    WAU8_WHEELS(GEN_SET_KEY)
+    pcontext->offset = 0U;
+}
+
+
+void wau8w_set_wheels(wau8w_context_t * pcontext, const wau8w_wheels_t * pwheels)
+{
+    pcontext->pwheels = pwheels;
+}
+
+
+// fills a set of wide wheels with pseudo-random values made from a seed
+// (splitmix64 of the seed and a counter, as wau8_make_wheels)
+void wau8w_make_wheels(wau8w_wheels_t * pwheels, const uint64_t seed)
+{
+    // wheels are laid out one after another so this fills them in order
+    uint64_t * p = (uint64_t *)pwheels;
+    const size_t nvals = sizeof(*pwheels) / sizeof(uint64_t);
+    size_t ii;
+
+    for (ii = 0; ii < nvals; ii++)
+    {
+        p[ii] = wau8_mix64(seed + ((uint64_t)(ii + 1U) * WAU8_MIX_GAMMA));
+    }
+}
+
+
+// advance the wheels one step (8 bytes of keystream)
+// from part way through a step this goes to the start of the next one
+#define GEN_ADVANCE(nm, ix, sz) \
+    pcontext->pos##nm = (WAU8_POS_T)WAU8_WRAP_INC(pcontext->pos##nm, sz);
+
+void wau8w_advance(wau8w_context_t * pcontext)
+{
+    WAU8_WHEELS(GEN_ADVANCE)
+    pcontext->offset = (pcontext->offset | 7U) + 1U;
+}
+
+
+// returns the 64-bit value for the current step
+#define GEN_GET_VAL(nm, ix, sz) \
+    result ^= pcontext->pwheels->nm[pcontext->pos##nm];
+
+uint64_t wau8w_get_val(const wau8w_context_t * pcontext)
+{
+    uint64_t result = 0U;
+    WAU8_WHEELS(GEN_GET_VAL)
+    return result;
+}
+
+
+// moves the wheels to the step holding keystream byte offset
+#define GEN_SEEK(nm, ix, sz) \
+    pcontext->pos##nm = (WAU8_POS_T)((pcontext->key[ix] + (step % (sz))) % (sz));
+
+void wau8w_seek(wau8w_context_t * pcontext, const uint64_t offset)
+{
+    const uint64_t step = offset / 8U;
+    WAU8_WHEELS(GEN_SEEK)
+    pcontext->offset = offset;
+}
+
+
+// returns number of keystream bytes since the key was set
+uint64_t wau8w_get_offset(const wau8w_context_t * pcontext)
+{
+    return pcontext->offset;
+}
+
+
+// fills buffer with the next sz encrypting/decrypting bytes
+void wau8w_keystream(wau8w_context_t * pcontext, uint8_t * pbuff, const size_t sz)
+{
+    memset(pbuff, 0, sz);
+    wau8w_xor(pcontext, pbuff, pbuff, sz);
+}
+
+
+// encrypts/decrypts sz bytes, a whole step (8 bytes) per lookup of the wheels
+// a step only partly used at either end is split bytewise and the wheels
+// stay on it so the next call picks up from the right byte
+// source and destination may be the same buffer
+#define GEN_LOAD_POS(nm, ix, sz)    unsigned int pos##nm = pcontext->pos##nm;
+#define GEN_LOOKUP(nm, ix, sz)      val ^= pw->nm[pos##nm];
+#define GEN_INC_POS(nm, ix, sz)     pos##nm = WAU8_WRAP_INC(pos##nm, sz);
+#define GEN_SAVE_POS(nm, ix, sz)    pcontext->pos##nm = (WAU8_POS_T)pos##nm;
+
+void wau8w_xor(
+    wau8w_context_t * pcontext,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz)
+{
+    const wau8w_wheels_t * pw = pcontext->pwheels;
+    size_t jj = 0U;
+    unsigned int lane = (unsigned int)(pcontext->offset & 7U);
+
+    // rest of a step started by an earlier call
+    if (lane != 0U)
+    {
+        uint64_t val = wau8w_get_val(pcontext);
+        for (; (jj < sz) && (lane < 8U); jj++, lane++)
+        {
+            pdst[jj] = psrc[jj] ^ (uint8_t)(val >> (8U * lane));
+        }
+        if (lane == 8U)
+        {
+            WAU8_WHEELS(GEN_ADVANCE)
+        }
+    }
+
+    {
+        WAU8_WHEELS(GEN_LOAD_POS)
+
+        for (; (sz - jj) >= 8U; jj += 8U)
+        {
+            uint64_t val = 0U;
+            uint64_t w;
+            WAU8_WHEELS(GEN_LOOKUP)
+            memcpy(&w, psrc + jj, 8U);
+            w ^= WAU8_LE64(val);
+            memcpy(pdst + jj, &w, 8U);
+            WAU8_WHEELS(GEN_INC_POS)
+        }
+
+        WAU8_WHEELS(GEN_SAVE_POS)
+    }
+
+    // start of a step the next call will finish
+    if (jj < sz)
+    {
+        uint64_t val = wau8w_get_val(pcontext);
+        for (lane = 0U; jj < sz; jj++, lane++)
+        {
+            pdst[jj] = psrc[jj] ^ (uint8_t)(val >> (8U * lane));
+        }
+    }
+
+    pcontext->offset += sz;
+}
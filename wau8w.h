@@ -0,0 +1,83 @@
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <https://unlicense.org>
+
+// Mark Whitney 2020
+
+#ifndef WAU8W_H_
+#define WAU8W_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "wau8.h"
+
+// wide variant of the machine
+//
+// same wheel sizes and key as wau8 but every wheel value is 64 bits,
+// so each step of the wheels gives 8 bytes of keystream instead of 1
+// for the same number of lookups
+// keystream bytes are the step values taken little-endian, so the
+// output is the same on every platform
+// the wheels are 8 times the size (about 16 KB for the default geometry)
+// and the keystream is not the same as wau8's for any choice of wheels
+// offsets count bytes like wau8, a step covers offsets 8t to 8t+7
+
+#define WAU8W_GEN_WHEEL(nm, ix, sz)     uint64_t nm[sz];
+
+typedef struct
+{
+    WAU8_WHEELS(WAU8W_GEN_WHEEL)
+} wau8w_wheels_t;
+
+typedef struct
+{
+    WAU8_WHEELS(WAU8_GEN_POS)
+    WAU8_POS_T key[WAU8_KEY_SZ];
+    uint64_t offset;
+    const wau8w_wheels_t * pwheels;
+} wau8w_context_t;
+
+
+void wau8w_set_key(wau8w_context_t * pcontext, const wau8_key_t pkey);
+void wau8w_set_wheels(wau8w_context_t * pcontext, const wau8w_wheels_t * pwheels);
+void wau8w_make_wheels(wau8w_wheels_t * pwheels, const uint64_t seed);
+void wau8w_advance(wau8w_context_t * pcontext);
+uint64_t wau8w_get_val(const wau8w_context_t * pcontext);
+void wau8w_seek(wau8w_context_t * pcontext, const uint64_t offset);
+uint64_t wau8w_get_offset(const wau8w_context_t * pcontext);
+
+void wau8w_keystream(wau8w_context_t * pcontext, uint8_t * pbuff, const size_t sz);
+void wau8w_xor(
+    wau8w_context_t * pcontext,
+    const uint8_t * psrc,
+    uint8_t * pdst,
+    const size_t sz);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WAU8W_H_